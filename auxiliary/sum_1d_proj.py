@@ -43,26 +43,45 @@ def is_acceptance_ok(subdirectory):
                 return False
 
 
+def list_projections(fitdir):
+    # either a 1dlhproj/ directory of files or one 1dlhproj.root container keyed by the same names
+    container = os.path.join(fitdir, "1dlhproj.root")
+    if os.path.isfile(container):
+        f = ROOT.TFile.Open(container)
+        names = [key.GetName() + ".root" for key in f.GetListOfKeys()]
+        f.Close()
+        return names
+    return os.listdir(os.path.join(fitdir, "1dlhproj"))
+
+
+def get_projection(fitdir, name):
+    container = os.path.join(fitdir, "1dlhproj.root")
+    if os.path.isfile(container):
+        f = ROOT.TFile.Open(container)
+        histo = f.Get(name.split(".root")[0]).Clone()
+    else:
+        f = ROOT.TFile.Open(os.path.join(fitdir, "1dlhproj", name))
+        histo = f.Get("").Clone()
+    histo.SetDirectory(0)
+    f.Close()
+    return histo
+
+
 os.chdir(directory)
 
 #get the list of all of the fit subdirectories
 fitdir_list = [s for s in os.listdir(directory) if "fit_" in s]
 
 #take the projection names and histogram binnings from the first subdirectory
-example_proj_dir = os.path.join(fitdir_list[0], "1dlhproj")
-proj_list =os.listdir(example_proj_dir)
+proj_list = list_projections(fitdir_list[0])
 bckg_list = []
 histo_list = []
 for i in range(0, len(proj_list)):
     bckg_list.append(((proj_list[i]).split("/"))[-1]) # just the name
-    projection_file = ROOT.TFile.Open(os.path.join(example_proj_dir, proj_list[i]))
-    projection_file.cd()
-    histo = projection_file.Get("").Clone()
-    histo.SetDirectory(0)
+    histo = get_projection(fitdir_list[0], proj_list[i])
     histo.Reset() #just keep the axises etc, don't wanna double count the first chain
     histo_list.append(histo)
     del histo
-    projection_file.Close()
 
 print "Summing projections for the following distributions: ", bckg_list
 
@@ -80,11 +99,8 @@ for j in range (0, len(bckg_list)):
             print "Ignoring chain with acceptance out of bounds!"
             continue
         
-        projection_file = ROOT.TFile.Open(os.path.join(subdirectory, "1dlhproj/{0}".format(ibck)))
-        projection_file.cd()
-        histo = projection_file.Get("")
+        histo = get_projection(subdirectory, ibck)
         histo_summed.Add(histo)
-        projection_file.Close()
         
     histo_summed.SetName("")
 
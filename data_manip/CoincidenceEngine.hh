@@ -0,0 +1,174 @@
+// Sliding window coincidence tagging over the RAT output chain
+// Only the timing/position branches (plus any payload branches asked for) are
+// read while tagging, events are held in a ring buffer until they fall out of
+// the time window, then handed on with their final pass flag
+#ifndef __BBFIT__CoincidenceEngine__
+#define __BBFIT__CoincidenceEngine__
+#include <TChain.h>
+#include <deque>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <iostream>
+#include <functional>
+#include <string>
+
+struct CoincidenceEvent{
+  Long64_t fEntry;
+  Long64_t fTime; // ns
+  Double_t fEnergy;
+  Double_t fX;
+  Double_t fY;
+  Double_t fZ;
+  Int_t    fNhits;
+  Bool_t   fFitValid;
+  bool     fVetoed;
+  std::vector<Double_t> fPayload; // extra branches, in the order they were added
+};
+
+struct CoincidenceWindow{
+  CoincidenceWindow() : fDeltaT(0), fShortDeltaT(-1), fDeltaR(-1), 
+                        fMinDelayedNhits(-1), 
+                        fMinPromptEnergy(-std::numeric_limits<double>::max()),
+                        fMinDelayedEnergy(-std::numeric_limits<double>::max()),
+                        fPromptFitValid(false), fDelayedFitValid(false) {}
+
+  double fDeltaT;       // pairs closer than this (ns) are tested
+  double fShortDeltaT;  // closer than this they don't need to be close in space
+  double fDeltaR;       // otherwise closer than this (mm), negative for no position cut
+  int    fMinDelayedNhits;  // delayed event needs more hits than this
+  double fMinPromptEnergy;  
+  double fMinDelayedEnergy;
+  bool   fPromptFitValid;
+  bool   fDelayedFitValid;
+
+  bool IsCoincidence(const CoincidenceEvent& prompt_, const CoincidenceEvent& delayed_) const{
+    double deltaT = std::abs(double(delayed_.fTime - prompt_.fTime));
+    if(deltaT >= fDeltaT)
+      return false;
+    if(delayed_.fNhits <= fMinDelayedNhits)
+      return false;
+    if(prompt_.fEnergy <= fMinPromptEnergy || delayed_.fEnergy <= fMinDelayedEnergy)
+      return false;
+    if((fPromptFitValid && !prompt_.fFitValid) || (fDelayedFitValid && !delayed_.fFitValid))
+      return false;
+    if(deltaT < fShortDeltaT || fDeltaR < 0)
+      return true;
+
+    double dx = delayed_.fX - prompt_.fX;
+    double dy = delayed_.fY - prompt_.fY;
+    double dz = delayed_.fZ - prompt_.fZ;
+    return dx * dx + dy * dy + dz * dz <= fDeltaR * fDeltaR;
+  }
+};
+
+class CoincidenceEngine{
+ public:
+  // called once per event, in entry order, when its flag is final
+  typedef std::function<void (const CoincidenceEvent&, bool)> Visitor;
+
+  CoincidenceEngine(const CoincidenceWindow& window_) : fWindow(window_), fTriggeredOnly(false) {}
+
+  // carry this (Double_t) branch along with each event, so callers can write
+  // it out from the visitor without going back to the chain
+  void AddPayloadBranch(const std::string& name_) {fPayloadBranches.push_back(name_);}
+
+  // skip untriggered events (evIndex < 0) before they reach the window
+  void SetTriggeredOnly(bool b_) {fTriggeredOnly = b_;}
+
+  // tags every pair inside the window; both members of a coincidence fail.
+  // The first and last events are assumed to be invalidated by events we didn't catch.
+  // Fills the list of surviving entries, returns the number of events that went
+  // through the window (only the triggered ones with SetTriggeredOnly)
+  Long64_t Run(TChain& chain_, std::vector<Long64_t>& passing_, 
+               Long64_t maxEntries_ = -1, Visitor visit_ = Visitor()){
+    chain_.SetBranchStatus("*", 0);
+    const char* branches[] = {"uTDays", "uTSecs", "uTNSecs", "energy", "fitValid",
+                              "posx", "posy", "posz", "nhits"};
+    for(size_t i = 0; i < sizeof(branches)/sizeof(branches[0]); i++)
+      chain_.SetBranchStatus(branches[i], 1);
+
+    Int_t days;
+    Int_t secs;
+    Int_t nsecs;
+    Int_t evIndex = 0;
+    CoincidenceEvent ev;
+    ev.fPayload.resize(fPayloadBranches.size());
+    for(size_t i = 0; i < fPayloadBranches.size(); i++){
+      chain_.SetBranchStatus(fPayloadBranches.at(i).c_str(), 1);
+      chain_.SetBranchAddress(fPayloadBranches.at(i).c_str(), &ev.fPayload[i]);
+    }
+    if(fTriggeredOnly){
+      chain_.SetBranchStatus("evIndex", 1);
+      chain_.SetBranchAddress("evIndex", &evIndex);
+    }
+
+    chain_.SetBranchAddress("uTDays", &days);
+    chain_.SetBranchAddress("uTSecs", &secs);
+    chain_.SetBranchAddress("uTNSecs", &nsecs);
+    chain_.SetBranchAddress("energy", &ev.fEnergy);
+    chain_.SetBranchAddress("fitValid", &ev.fFitValid);
+    chain_.SetBranchAddress("posx", &ev.fX);
+    chain_.SetBranchAddress("posy", &ev.fY);
+    chain_.SetBranchAddress("posz", &ev.fZ);
+    chain_.SetBranchAddress("nhits", &ev.fNhits);
+
+    Long64_t nEntries = chain_.GetEntries();
+    if(maxEntries_ >= 0 && maxEntries_ < nEntries)
+      nEntries = maxEntries_;
+
+    passing_.clear();
+    fBuffer.clear();
+    Long64_t nProcessed = 0;
+    Long64_t onePercent = nEntries/100;
+    for(Long64_t i = 0; i < nEntries; i++){
+      if(onePercent && !(i%onePercent))
+        std::cout << i/onePercent << "% done " << std::endl;
+
+      chain_.GetEntry(i);
+      if(fTriggeredOnly && evIndex < 0)
+        continue;
+
+      ev.fEntry = i;
+      ev.fTime = (Long64_t(days) * 86400 + secs) * 1000000000LL + nsecs;
+      ev.fVetoed = !nProcessed++;
+
+      // anything now further back than the window can't be touched again
+      while(!fBuffer.empty() && 
+            std::abs(double(ev.fTime - fBuffer.front().fTime)) >= fWindow.fDeltaT)
+        Release(passing_, visit_);
+
+      for(size_t j = 0; j < fBuffer.size(); j++)
+        if(fWindow.IsCoincidence(fBuffer[j], ev)){
+          fBuffer[j].fVetoed = true;
+          ev.fVetoed = true;
+        }
+      fBuffer.push_back(ev);
+    }
+    if(!fBuffer.empty())
+      fBuffer.back().fVetoed = true;
+    while(!fBuffer.empty())
+      Release(passing_, visit_);
+
+    // hand the chain back with everything switched on and our addresses dropped
+    chain_.SetBranchStatus("*", 1);
+    chain_.ResetBranchAddresses();
+    return nProcessed;
+  }
+
+ private:
+  void Release(std::vector<Long64_t>& passing_, Visitor& visit_){
+    const CoincidenceEvent& ev = fBuffer.front();
+    if(!ev.fVetoed)
+      passing_.push_back(ev.fEntry);
+    if(visit_)
+      visit_(ev, !ev.fVetoed);
+    fBuffer.pop_front();
+  }
+
+  CoincidenceWindow fWindow;
+  bool fTriggeredOnly;
+  std::vector<std::string> fPayloadBranches;
+  std::deque<CoincidenceEvent> fBuffer;
+};
+#endif
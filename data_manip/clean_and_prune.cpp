@@ -0,0 +1,136 @@
+// remove_notrigs + cut_bipos/clean_alpha_n + make_trees in one pass over the RAT output:
+// untriggered events are dropped, the coincidence vetoes applied and the survivors 
+// written straight to the pruned ntuple, no intermediate full copies of the tree
+#include <TChain.h>
+#include <TNtuple.h>
+#include <TVector3.h>
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+#include <TFile.h>
+#include <TH1D.h>
+#include <sstream>
+#include <sys/stat.h>
+#include "CoincidenceEngine.hh"
+
+const double rav = 6005;
+
+double 
+Reff(double x_, double y_, double z_){
+  return pow((sqrt(x_ * x_ + y_ * y_ + z_ * z_)/rav), 3);
+}
+
+void
+CleanAndPrune(const std::string& infiles_, const std::string& outfile_, const CoincidenceWindow& window_,
+              const std::string& histPrefix_, const std::string& histDir_, int testing_){
+    TChain c("output");
+    c.Add(infiles_.c_str());
+
+    struct stat st = {0};
+    if (stat(histDir_.c_str(), &st) == -1) {
+      mkdir(histDir_.c_str(), 0700);
+    }
+
+    TFile output(outfile_.c_str(), "RECREATE");
+    TNtuple nt("pruned", "", "energy:fitValid:reff:qmcdep:bipoCumul:biPoLikelihood214:itr:timePSD:anglePSD");
+
+    // everything the pruned ntuple needs beyond what the coincidence test reads anyway
+    CoincidenceEngine engine(window_);
+    engine.SetTriggeredOnly(true);
+    engine.AddPayloadBranch("mcEdepQuenched");
+    engine.AddPayloadBranch("biPoCumul");
+    engine.AddPayloadBranch("biPoLikelihood214");
+    engine.AddPayloadBranch("itr");
+    engine.AddPayloadBranch("ext0NuTimeTl208AVNaive");
+    engine.AddPayloadBranch("ext0NuAngleTl208AV");
+
+    int roiCount = 0;
+    int roiPassCount = 0;
+
+    TH1D beforeEnergy("b", "", 1000, 0, 10);
+    TH1D afterEnergy("a", "", 1000, 0, 10);
+
+    std::vector<Long64_t> passing;
+    Long64_t nTriggered = engine.Run(c, passing, testing_ ? 11 : -1, 
+                                     [&](const CoincidenceEvent& ev_, bool passes_){
+      beforeEnergy.Fill(ev_.fEnergy);
+      if(passes_)
+	afterEnergy.Fill(ev_.fEnergy);
+
+      if((ev_.fEnergy > 2.47) && (ev_.fEnergy < 2.64) && (TVector3(ev_.fX, ev_.fY, ev_.fZ).Mag() < 3500) && ev_.fFitValid == 1){
+	roiCount++;
+	if(passes_)
+	  roiPassCount++;
+      }
+
+      if(passes_){
+	const std::vector<Double_t>& p = ev_.fPayload;
+	nt.Fill(ev_.fEnergy, ev_.fFitValid, Reff(ev_.fX, ev_.fY, ev_.fZ), 
+		p[0], p[1], p[2], p[3], p[4], p[5]);
+      }
+    });
+
+    std::cout << "For the roi  " << roiPassCount << " pass out of " << roiCount << std::endl;
+    std::cout << passing.size() << " / " << nTriggered << " triggered events written to " << outfile_ << std::endl;
+
+    beforeEnergy.SaveAs((histDir_ + "/" + histPrefix_ + "_energy_before.root").c_str());
+    afterEnergy.SaveAs((histDir_ + "/" + histPrefix_ + "_energy_after.root").c_str());
+
+    output.cd();
+    nt.Write();
+    output.Close();
+}    
+
+
+
+int main(int argc, char* argv[]){
+  std::string mode = argc > 3 ? argv[3] : "";
+  if(!((mode == "bipo" && argc == 10) || (mode == "alphan" && argc == 8))){
+    std::cout << "Usage: ./clean_and_prune <infiles> <outfile> bipo time_diff_short time_diff_long r_diff n_cut hist_dir testing" << std::endl;
+    std::cout << "       ./clean_and_prune <infiles> <outfile> alphan e_min time_diff hist_dir testing" << std::endl;
+    return 1;
+  }
+
+  CoincidenceWindow window;
+  std::string histPrefix;
+  if(mode == "bipo"){
+    float timeDiffShort;
+    std::istringstream(argv[4]) >> timeDiffShort;
+
+    float timeDiffLong;
+    std::istringstream(argv[5]) >> timeDiffLong;
+
+    float rDiff;
+    std::istringstream(argv[6]) >> rDiff;
+
+    int nCut;
+    std::istringstream(argv[7]) >> nCut;
+
+    window.fDeltaT = std::max(timeDiffShort, timeDiffLong);
+    window.fShortDeltaT = timeDiffShort;
+    window.fDeltaR = rDiff;
+    window.fMinDelayedNhits = nCut;
+    window.fPromptFitValid = true;
+    histPrefix = "bipo";
+  }
+  else{
+    float energy;
+    std::istringstream(argv[4]) >> energy;
+
+    float timeDiff;
+    std::istringstream(argv[5]) >> timeDiff;
+
+    window.fDeltaT = timeDiff;
+    window.fMinPromptEnergy = energy;
+    window.fMinDelayedEnergy = energy;
+    window.fPromptFitValid = true;
+    window.fDelayedFitValid = true;
+    histPrefix = "an";
+  }
+
+  int testing;
+  std::istringstream(argv[argc - 1]) >> testing;
+
+  CleanAndPrune(std::string(argv[1]), std::string(argv[2]), window, histPrefix, std::string(argv[argc - 2]), testing);
+  return 0;
+}
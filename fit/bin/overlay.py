@@ -25,6 +25,16 @@ def grab_hist(filename):
     h.SetDirectory(0)    
     return h
 
+def grab_container(filename):
+    # all the histograms of a single output container, by name
+    f = ROOT.TFile(filename)
+    hists = {}
+    for key in f.GetListOfKeys():
+        h = f.Get(key.GetName())
+        h.SetDirectory(0)
+        hists[key.GetName()] = h
+    return hists
+
 def stack(order, hists, labels, colors):
     stack = ROOT.THStack("fit", "")
     leg   = ROOT.TLegend(0.75, 0.65, 0.95, 0.95)
@@ -156,17 +166,22 @@ if __name__ == "__main__":
     parser.add_argument("result_dir", type=str)
     parser.add_argument("--proj_titles_file", type=str)
     args = parser.parse_args()
-    data  = grab_hist(os.path.join(args.result_dir, "scaled_dists", "data.root"))
-    data.Sumw2()
+    container = os.path.join(args.result_dir, "scaled_dists.root")
+    if os.path.isfile(container):
+        scaled_dists = grab_container(container)
+        data = scaled_dists.pop("data")
+    else:
+        data  = grab_hist(os.path.join(args.result_dir, "scaled_dists", "data.root"))
 
-    # read 
-    scaled_dists_p = [ x for x in glob.glob(os.path.join(args.result_dir, "scaled_dists", "*.root")) if not x.endswith("data.root")]
-    names = [os.path.basename(x).split(".root")[0] for x in scaled_dists_p]
+        # read 
+        scaled_dists_p = [ x for x in glob.glob(os.path.join(args.result_dir, "scaled_dists", "*.root")) if not x.endswith("data.root")]
+        names = [os.path.basename(x).split(".root")[0] for x in scaled_dists_p]
     
     
-    scaled_dists = {}
-    for name, path in zip(names, scaled_dists_p):
-        scaled_dists[name] = grab_hist(path)
+        scaled_dists = {}
+        for name, path in zip(names, scaled_dists_p):
+            scaled_dists[name] = grab_hist(path)
+    data.Sumw2()
 
     # read from the config file if these guys are in a group
     parser = ConfigParser.ConfigParser()
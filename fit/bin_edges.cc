@@ -0,0 +1,118 @@
+// derive equal statistics bin edges along one axis from the rate weighted sum of
+// the background pdfs. Build the pdfs finely binned first, paste the output into
+// the axis section of the pdf config and rebuild
+#include <DistConfigLoader.hh>
+#include <DistConfig.hh>
+#include <EventConfig.hh>
+#include <EventConfigLoader.hh>
+#include <PdfBundle.hh>
+#include <BinnedED.h>
+#include <AxisCollection.h>
+#include <IO.h>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+using namespace bbfit;
+
+int main(int argc, char *argv[]){
+  if (argc != 5 && argc != 7){
+    std::cout << "\nUsage: bin_edges <event_config_file> <pdf_config_file> <axis> <n_bins> [--exclude name1,name2]" << std::endl;
+    return 1;
+  }
+
+  std::string evConfigFile(argv[1]);
+  std::string pdfConfigFile(argv[2]);
+  std::string axisName(argv[3]);
+  int nBins = atoi(argv[4]);
+  if(nBins < 1){
+    std::cout << "n_bins must be at least 1" << std::endl;
+    return 1;
+  }
+
+  // usually the signal, so the edges follow the background
+  std::vector<std::string> excluded;
+  if(argc == 7){
+    if(std::string(argv[5]) != "--exclude"){
+      std::cout << "Unknown option " << argv[5] << std::endl;
+      return 1;
+    }
+    std::stringstream ss(argv[6]);
+    std::string name;
+    while(std::getline(ss, name, ','))
+      excluded.push_back(name);
+  }
+
+  DistConfigLoader pLoader(pdfConfigFile);
+  DistConfig pConfig = pLoader.Load();
+  std::string pdfDir = pConfig.GetPDFDir();
+
+  typedef std::map<std::string, EventConfig> EvMap;
+  EventConfigLoader loader(evConfigFile);
+  EvMap toGet = loader.LoadActive();
+
+  PdfBundle* bundle = NULL;
+  if(pConfig.GetBundle())
+    bundle = new PdfBundle(PdfBundle::BundlePath(pdfDir));
+
+  std::vector<std::string> keep(1, axisName);
+  BinnedED summed;
+  bool first = true;
+  for(EvMap::iterator it = toGet.begin(); it != toGet.end(); ++it){
+    if(std::find(excluded.begin(), excluded.end(), it->first) != excluded.end())
+      continue;
+    if(!it->second.GetRate())
+      continue;
+
+    std::string distPath = pdfDir + "/" + it->first + ".h5";
+    std::cout << "Adding " << it->first << " at rate " << it->second.GetRate() << std::endl;
+    BinnedED dist = bundle ? bundle->Load(it->first) : BinnedED(it->first, IO::LoadHistogram(distPath));
+    dist.SetObservables(pConfig.GetBranchNames());
+    BinnedED marginal = dist.GetNDims() > 1 ? dist.Marginalise(keep) : dist;
+    if(!marginal.Integral())
+      continue;
+    marginal.Scale(it->second.GetRate() / marginal.Integral());
+    if(first){
+      summed = marginal;
+      first = false;
+    }
+    else
+      summed.Add(marginal);
+  }
+  delete bundle;
+
+  if(first){
+    std::cout << "No pdfs to sum!" << std::endl;
+    return 1;
+  }
+
+  // edges can only go on the fine boundaries, so a sharp peak can leave fewer
+  // than n_bins
+  const BinAxis& axis = summed.GetAxes().GetAxis(0);
+  double total = summed.Integral();
+  std::vector<double> edges(1, axis.GetMinimum());
+  double cumulative = 0;
+  int next = 1;
+  for(size_t i = 0; i < axis.GetNBins() && next < nBins; i++){
+    cumulative += summed.GetBinContent(i);
+    if(cumulative < next * total / nBins)
+      continue;
+    if(i + 1 < axis.GetNBins())
+      edges.push_back(axis.GetBinHighEdge(i));
+    while(next < nBins && cumulative >= next * total / nBins)
+      next++;
+  }
+  edges.push_back(axis.GetMaximum());
+
+  if(edges.size() - 1 < size_t(nBins))
+    std::cout << "\nOnly " << edges.size() - 1 << " bins possible at this resolution" << std::endl;
+
+  std::cout << "\n[" << axisName << "]" << std::endl;
+  std::cout << "bin_edges = ";
+  for(size_t i = 0; i < edges.size(); i++)
+    std::cout << (i ? "," : "") << edges.at(i);
+  std::cout << std::endl;
+  return 0;
+}
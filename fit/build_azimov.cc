@@ -4,6 +4,7 @@
 #include <DistConfig.hh>
 #include <EventConfig.hh>
 #include <ROOTNtuple.h>
+#include <DataSetView.hh>
 #include <IO.h>
 #include <BinnedED.h>
 #include <AxisCollection.h>
@@ -39,6 +40,8 @@ BuildAzimov(const std::string& evConfigFile_,
     typedef std::vector<CutConfig> CutVec;
     CutConfigLoader cutConfLoader(cutConfigFile_);
     CutVec cutConfs = cutConfLoader.LoadActive();
+    bool useCutIndex = cutConfLoader.LoadUseCutIndex();
+    bool adaptiveOrder = cutConfLoader.LoadAdaptiveOrder();
 
     CutCollection cutCol;
     for(CutVec::iterator it = cutConfs.begin(); it != cutConfs.end();
@@ -65,9 +68,10 @@ BuildAzimov(const std::string& evConfigFile_,
 
     // now build each of the PDFs, scale them to the correct size and add it to the azimov
     for(EvMap::iterator it = toGet.begin(); it != toGet.end(); ++it){
-        DataSet* ds = new ROOTNtuple(it->second.GetSplitFakePath(), "pruned");
+        DataSet* ds = DataSetView::Open(it->second.GetSplitFakePath(), "pruned");
         BinnedED dist;
-        dist = DistBuilder::Build(it->first, pConfig, ds, cutCol, log);
+        dist = DistBuilder::Build(it->first, pConfig, it->second.GetSplitFakePath(), 
+                                  cutConfs, log, useCutIndex, adaptiveOrder);
         unsigned long nGen = ds->GetNEntries();
         if(it->second.GetNGenerated()){
             nGen = it->second.GetNGenerated();
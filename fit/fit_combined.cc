@@ -0,0 +1,153 @@
+// joint fit of several data sets with some parameters shared between them, 
+// see CombinedFitConfigLoader for the config
+#include <string>
+#include <CombinedFitSetup.hh>
+#include <CombinedFitConfig.hh>
+#include <CombinedNLLH.hh>
+#include <FitSetup.hh>
+#include <fstream>
+#include <BinnedED.h>
+#include <ParameterLayout.hh>
+#include <WarmStart.hh>
+#include <FitRunner.hh>
+#include <Rand.h>
+#include <IO.h>
+#include <OutputContainer.hh>
+
+using namespace bbfit;
+
+typedef FitRunner::HistMap HistMap;
+
+void
+Fit(const std::string& configFile_, const std::string& dims_, 
+    const std::string& outDirOverride_, const std::string& mode_,
+    const std::string& initFrom_){
+  Rand::SetSeed(0);
+
+  CombinedFitSetup setup(configFile_, dims_);
+  const CombinedFitConfig& config = setup.GetConfig();
+  const ParameterLayout& layout = setup.GetLayout();
+
+  std::string outDir = config.GetOutDir();
+  if(outDirOverride_ != "")
+    outDir = outDirOverride_;
+  std::string projDir1D = outDir + "/1dlhproj";
+  std::string projDir2D = outDir + "/2dlhproj";
+  std::string scaledDistDir = outDir + "/scaled_dists";
+
+  // the first data set's dist config decides how the output is written
+  bool container = setup.GetFitSetup(0).GetDistConfig().GetOutputContainer();
+  FitRunner::MakeDir(outDir);
+  if(!container){
+    FitRunner::MakeDir(projDir1D);
+    FitRunner::MakeDir(projDir2D);
+  }
+  FitRunner::MakeDir(scaledDistDir);
+
+  CombinedNLLH lh = setup.BuildLikelihood();
+  for(size_t d = 0; d < lh.GetNDataSets(); d++){
+    const IndexedBinnedNLLH& sub = lh.GetDataSet(d);
+    std::cout << "Likelihood " << lh.GetDataSetName(d) << ": " << sub.GetNOccupiedBins() 
+              << " of " << sub.GetNBins() << " bins have data" << std::endl;
+
+    const std::string& cutLog = setup.GetFitSetup(d).GetDataCutLog();
+    if(cutLog != ""){
+      std::ofstream ofs((outDir + "/data_cut_log_" + lh.GetDataSetName(d) + ".txt").c_str());
+      ofs << cutLog;
+    }
+  }
+  std::cout << "Fitting " << layout.GetNParams() << " parameters across " 
+            << lh.GetNDataSets() << " data sets" << std::endl;
+
+  FitRunner::Result result;
+
+  WarmStart* warm = NULL;
+  if(initFrom_ != ""){
+    std::cout << "Warm starting from " << initFrom_ << std::endl;
+    warm = new WarmStart(initFrom_, layout);
+  }
+
+  if(mode_ == "map"){
+    std::vector<double> x = FitRunner::BoxCentre(layout);
+    if(warm)
+      x = warm->GetInitialPoint();
+    result = FitRunner::RunMAP(lh, layout, x, outDir + "/covariance.txt");
+  }
+  else
+    result = FitRunner::RunHMC(lh, layout, config.GetEpsilon(), config.GetNSteps(), 
+                               config.GetIterations(), config.GetBurnIn(), warm,
+                               outDir + "/covariance.txt");
+  delete warm;
+  ParameterDict bestFit = layout.ToDict(result.fBestFit);
+  FitRunner::SaveResult(result, layout, outDir + "/fit_result.txt");
+
+  FitRunner::SaveHists(result.f1DProjections, projDir1D, container);
+  FitRunner::SaveHists(result.f2DProjections, projDir2D, container);
+
+  // each data set's pdfs at their own best fit normalisations, next to its data
+  for(size_t d = 0; d < setup.GetNDataSets(); d++){
+    const FitSetup& dataSet = setup.GetFitSetup(d);
+    std::string dir = scaledDistDir + "/" + setup.GetDataSetName(d);
+    if(!container)
+      FitRunner::MakeDir(dir);
+
+    std::vector<std::string> keepObs;
+    keepObs.push_back("r");
+    keepObs.push_back("energy");
+    bool marginalise = dataSet.GetDataDist().GetHistogram().GetNDims() >= 3;
+
+    HistMap scaled;
+    std::vector<BinnedED> dists = dataSet.GetDists();
+    for(size_t i = 0; i < dists.size(); i++){
+      std::string name = dists.at(i).GetName();
+      dists[i].Normalise();
+      dists[i].Scale(bestFit[setup.CombinedName(d, name)]);
+      if(marginalise)
+        dists[i] = dists[i].Marginalise(keepObs);
+      scaled.insert(std::make_pair(name, dists[i].GetHistogram()));
+    }
+    BinnedED dataDist = dataSet.GetDataDist();
+    if(marginalise)
+      dataDist = dataDist.Marginalise(keepObs);
+    scaled.insert(std::make_pair(std::string("data"), dataDist.GetHistogram()));
+    FitRunner::SaveHists(scaled, dir, container);
+  }
+
+  if(mode_ != "map"){
+    std::ofstream cofs((outDir + "/auto_correlations.txt").c_str());
+    for(size_t i = 0; i < result.fAutoCorrelations.size(); i++)
+      cofs << i << "\t" << result.fAutoCorrelations.at(i) << "\n";
+  }
+
+  // and a copy of the configuration used
+  std::ifstream ifs(configFile_.c_str(), std::ios_base::binary);
+  std::ofstream of((outDir + "/config_log.txt").c_str(), std::ios_base::binary);
+  of << ifs.rdbuf();
+}
+
+int main(int argc, char *argv[]){
+  std::string mode = "mcmc";
+  std::string initFrom;
+  std::vector<std::string> args;
+  for(int i = 1; i < argc; i++){
+    std::string arg(argv[i]);
+    if(arg == "--mode" && i + 1 < argc)
+      mode = argv[++i];
+    else if(arg == "--init-from" && i + 1 < argc)
+      initFrom = argv[++i];
+    else
+      args.push_back(arg);
+  }
+
+  if ((args.size() != 2 && args.size() != 3) || (mode != "mcmc" && mode != "map")){
+    std::cout << "\nUsage: fit_combined [--mode mcmc|map] [--init-from <fit_result.txt or fit dir>] <combined_config_file> <4d,3d or 2d> <(opt) outdir_override>" << std::endl;
+    return 1;
+  }
+
+  std::string outDirOverride;
+  if(args.size() == 3)
+    outDirOverride = args.at(2);
+
+  Fit(args.at(0), args.at(1), outDirOverride, mode, initFrom);
+  return 0;
+}
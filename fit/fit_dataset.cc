@@ -1,51 +1,40 @@
 #include <string>
-#include <FitConfigLoader.hh>
-#include <DistConfigLoader.hh>
-#include <DistConfig.hh>
-#include <DistBuilder.hh>
-#include <CutConfigLoader.hh>
-#include <FitConfigLoader.hh>
+#include <FitSetup.hh>
 #include <FitConfig.hh>
-#include <CutFactory.hh>
-#include <CutCollection.h>
 #include <fstream>
-#include <ROOTNtuple.h>
-#include <BinnedNLLH.h>
-#include <sys/stat.h>
+#include <BinnedED.h>
+#include <ParameterLayout.hh>
+#include <IndexedBinnedNLLH.hh>
+#include <WarmStart.hh>
+#include <FitRunner.hh>
 #include <Rand.h>
 #include <AxisCollection.h>
 #include <IO.h>
-#include <MCMC.h>
-#include <HamiltonianSampler.h>
-#include <MetropolisSampler.h>
+#include <OutputContainer.hh>
 
 using namespace bbfit;
 
+typedef FitRunner::HistMap HistMap;
+
 void
 Fit(const std::string& mcmcConfigFile_, 
     const std::string& distConfigFile_,
     const std::string& cutConfigFile_, 
     const std::string& dataPath_,
     const std::string& dims_,
-    const std::string& outDirOverride_){
+    const std::string& outDirOverride_,
+    const std::string& mode_,
+    bool sharePdfs_,
+    const std::string& initFrom_){
     Rand::SetSeed(0);
 
 
-    // Load up the configuration data
-    FitConfig mcConfig;
-  
-    typedef std::vector<CutConfig> CutVec;
-    CutVec cutConfs;
-    
-    {
-        FitConfigLoader mcLoader(mcmcConfigFile_);
-        mcConfig = mcLoader.LoadActive();
-    
-        CutConfigLoader cutConfLoader(cutConfigFile_);
-        cutConfs = cutConfLoader.LoadActive();
-    }
-    
-
+    // Load up the configuration, pdfs and data
+    FitSetup setup(mcmcConfigFile_, distConfigFile_, cutConfigFile_, dataPath_, dims_, sharePdfs_);
+    const FitConfig& mcConfig = setup.GetFitConfig();
+    const ParameterLayout& layout = setup.GetLayout();
+    std::string distDir = setup.GetDistConfig().GetPDFDir();
+    BinnedED dataDist = setup.GetDataDist();
 
     // create the output directories
     std::string outDir = mcConfig.GetOutDir();
@@ -55,208 +44,79 @@ Fit(const std::string& mcmcConfigFile_,
     std::string projDir1D = outDir + "/1dlhproj";
     std::string projDir2D = outDir + "/2dlhproj";
     std::string scaledDistDir = outDir + "/scaled_dists";
+    bool container = setup.GetDistConfig().GetOutputContainer();
     
-    struct stat st = {0};
-    if (stat(outDir.c_str(), &st) == -1) {
-        mkdir(outDir.c_str(), 0700);
+    FitRunner::MakeDir(outDir);
+    if(!container){
+        FitRunner::MakeDir(projDir1D);
+        FitRunner::MakeDir(projDir2D);
+        FitRunner::MakeDir(scaledDistDir);
     }
-    
-    if (stat(projDir1D.c_str(), &st) == -1) {
-        mkdir(projDir1D.c_str(), 0700);
-    }
-    
-    if (stat(projDir2D.c_str(), &st) == -1) {
-        mkdir(projDir2D.c_str(), 0700);
-    }
-    
-    if (stat(scaledDistDir.c_str(), &st) == -1) {
-        mkdir(scaledDistDir.c_str(), 0700);
-    }
-        
 
-  // Make the cuts
-  CutCollection cutCol;
-  for(CutVec::iterator it = cutConfs.begin(); it != cutConfs.end();
-      ++it){
-    std::string name = it->GetName();
-    std::string type = it->GetType();
-    std::string obs = it->GetObs();
-    double val = it->GetValue();
-    double val2 = it->GetValue2();
-    Cut *cut = CutFactory::New(name, type, obs, val, val2);
-    cutCol.AddCut(*cut);
-    delete cut; // cut col takes its own copy
-  }
-  
-
-  // Load up the dists
-  DistConfigLoader dLoader(distConfigFile_);
-  DistConfig pConfig = dLoader.Load();
-  std::string distDir = pConfig.GetPDFDir();
-
-  std::vector<BinnedED> dists;
-  
-  
-  // the ones you actually want to fit are those listed in mcmcconfig
-  typedef std::set<std::string> StringSet;
-  StringSet distsToFit = mcConfig.GetParamNames();
-  
-
-  for(StringSet::iterator it = distsToFit.begin(); it != distsToFit.end();
-      ++it){
-    std::string distPath = distDir + "/" + *it + ".h5";
-    dists.push_back(BinnedED(*it, IO::LoadHistogram(distPath)));
-  }
-
-
-  // if its a root tree then load it up
-  BinnedED dataDist;
- 
-  if(dataPath_.substr(dataPath_.find_last_of(".") + 1) == "h5"){
-      Histogram loaded = IO::LoadHistogram(dataPath_);
-      dataDist = BinnedED("data", loaded);
-      dataDist.SetObservables(pConfig.GetBranchNames());
-  }
-  else{
-      // Load up the data set
-      ROOTNtuple dataToFit(dataPath_, "pruned");
-      
-      // Log the effects of the cuts
-      CutLog log(cutCol.GetCutNames());
-      
-      // and bin the data inside
-      dataDist = DistBuilder::Build("data", pConfig, (DataSet*)&dataToFit, cutCol, log);
-      
-  // 
+  // Log the effects of the cuts on the data
+  if(setup.GetDataCutLog() != ""){
       std::ofstream ofs((outDir + "/data_cut_log.txt").c_str());
-      ofs << "Cut log for data set " << dataPath_ << std::endl;
-      ofs << log.AsString() << std::endl;
+      ofs << setup.GetDataCutLog();
       ofs.close();
   }
 
-  //marginalise over PSD for 3D fitting
-  if(dims_=="3d"){
-      std::cout<< "Marginilising for 3d" << std::endl;
-      std::vector<std::string> keepObs;
-      keepObs.push_back("energy");
-      keepObs.push_back("r");
-      keepObs.push_back("timePSD");
-      dataDist = dataDist.Marginalise(keepObs);
-  }
-
-	
-  //marginalise over PSD for 2D fitting
-  if(dims_=="2d"){
-      std::cout<< "Marginilising for 32" << std::endl;
-      std::vector<std::string> keepObs;
-      keepObs.push_back("energy");
-      keepObs.push_back("r");
-      dataDist = dataDist.Marginalise(keepObs);
-  }
-
 // now build the likelihood
-  BinnedNLLH lh;
-  lh.AddPdfs(dists);
-  lh.SetCuts(cutCol);
-  lh.SetDataDist(dataDist);
+  IndexedBinnedNLLH lh = setup.BuildLikelihood();
+  std::cout << "Likelihood: " << lh.GetNOccupiedBins() << " of " << lh.GetNBins() 
+            << " bins have data" << std::endl;
 
-  ParameterDict constrMeans  = mcConfig.GetConstrMeans();
-  ParameterDict constrSigmas = mcConfig.GetConstrSigmas();
-  for(ParameterDict::iterator it = constrMeans.begin(); it != constrMeans.end();
-      ++it)
-      lh.SetConstraint(it->first, it->second, constrSigmas.at(it->first));
-
-  // and now the optimiser
-  // Create something to do hamiltonian sampling
-  ParameterDict sigmas = mcConfig.GetSigmas();
-
-  HamiltonianSampler<BinnedNLLH> sampler(lh, mcConfig.GetEpsilon(), 
-                                         mcConfig.GetNSteps());
-  sampler.SetMinima(mcConfig.GetMinima());
-  sampler.SetMaxima(mcConfig.GetMaxima());
-  ParameterDict masses;
-
-  for(ParameterDict::iterator it = sigmas.begin(); it != sigmas.end(); ++it)
-      masses[it->first] = 1/sigmas[it->first]/1/sigmas[it->first];
-
-  sampler.SetMasses(masses);
-  
-  MCMC mh(sampler);
-
-  mh.SetMaxIter(mcConfig.GetIterations());
-  mh.SetBurnIn(mcConfig.GetBurnIn());
-  mh.SetMinima(mcConfig.GetMinima());
-  mh.SetMaxima(mcConfig.GetMaxima());
-  
-  // we're going to minmise not maximise -log(lh) and the 
-  // mc chain needs to know that the test stat is logged 
-  // otherwise it will give us the distribution of the log(lh) not the lh
+  FitRunner::Result result;
 
-  mh.SetTestStatLogged(true);
-  mh.SetFlipSign(true);
-  
-  // create some axes for the mc to fill
-  AxisCollection lhAxes;
-  for(StringSet::iterator it = distsToFit.begin(); it != distsToFit.end();
-      ++it){
-    lhAxes.AddAxis(BinAxis(*it, mcConfig.GetMinima()[*it], 
-			   mcConfig.GetMaxima()[*it],
-			   mcConfig.GetNBins()[*it]		   
-			   )
-		   );
+  // an earlier fit of something similar, to start from
+  WarmStart* warm = NULL;
+  if(initFrom_ != ""){
+      std::cout << "Warm starting from " << initFrom_ << std::endl;
+      warm = new WarmStart(initFrom_, layout);
   }
-
-  mh.SetHistogramAxes(lhAxes);
   
-  // go
-  const FitResult& res = mh.Optimise(&lh);
-  lh.SetParameters(res.GetBestFit());
+  if(mode_ == "map"){
+      // find the mode, from the warm start if there is one
+      std::vector<double> x = FitRunner::BoxCentre(layout);
+      if(warm)
+          x = warm->GetInitialPoint();
+      result = FitRunner::RunMAP(lh, layout, x, outDir + "/covariance.txt");
+  }
+  else
+      result = FitRunner::RunHMC(lh, layout, mcConfig.GetEpsilon(), mcConfig.GetNSteps(), 
+                                 mcConfig.GetIterations(), mcConfig.GetBurnIn(), warm,
+                                 outDir + "/covariance.txt");
+  delete warm;
+  ParameterDict bestFit = layout.ToDict(result.fBestFit);
 
   // Now save the results
-  res.SaveAs(outDir + "/fit_result.txt");
-  
-  std::cout << "Saved fit result to " << outDir + "/fit_result.txt"
-            << std::endl;
-
-  MCMCSamples samples = mh.GetSamples();
+  FitRunner::SaveResult(result, layout, outDir + "/fit_result.txt");
 
   // save the histograms
-  typedef std::map<std::string, Histogram> HistMap;
-  const HistMap& proj1D = samples.Get1DProjections();
-  const HistMap& proj2D = samples.Get2DProjections();
-
   std::cout << "Saving LH projections to \n\t" 
-            << projDir1D
+            << (container ? OutputContainer::PathFor(projDir1D) : projDir1D)
             << "\n\t"
-            << projDir2D
+            << (container ? OutputContainer::PathFor(projDir2D) : projDir2D)
             << std::endl;
 
-  for(HistMap::const_iterator it = proj1D.begin(); it != proj1D.end();
-      ++it){
-    IO::SaveHistogram(it->second, projDir1D + "/" + it->first + ".root");
-  }
-
-  for(HistMap::const_iterator it = proj2D.begin(); it != proj2D.end();
-      ++it){
-    IO::SaveHistogram(it->second, projDir2D + "/" + it->first + ".root");
-  }
+  FitRunner::SaveHists(result.f1DProjections, projDir1D, container);
+  FitRunner::SaveHists(result.f2DProjections, projDir2D, container);
 
   // scale the distributions to the correct heights
   // they are named the same as their fit parameters
   std::cout << "Saving scaled histograms and data to \n\t"
-            << scaledDistDir << std::endl;
+            << (container ? OutputContainer::PathFor(scaledDistDir) : scaledDistDir) << std::endl;
+
+  std::vector<BinnedED> dists = setup.GetDists();
+  HistMap scaled;
 
   if(dataDist.GetHistogram().GetNDims() < 3){
-      ParameterDict bestFit = res.GetBestFit();
       for(size_t i = 0; i < dists.size(); i++){
 	  std::string name = dists.at(i).GetName();
 	  dists[i].Normalise();
 	  dists[i].Scale(bestFit[name]);
-	  IO::SaveHistogram(dists[i].GetHistogram(), 
-                            scaledDistDir + "/" + name + ".root");
+	  scaled.insert(std::make_pair(name, dists[i].GetHistogram()));
       }
   }else{
-      ParameterDict bestFit = res.GetBestFit();
       for(size_t i = 0; i < dists.size(); i++){
 	  std::string name = dists.at(i).GetName();
 	  dists[i].Normalise();
@@ -266,30 +126,31 @@ Fit(const std::string& mcmcConfigFile_,
 	  keepObs.push_back("r");
 	  keepObs.push_back("energy");
 	  dists[i] = dists[i].Marginalise(keepObs);
-	  IO::SaveHistogram(dists[i].GetHistogram(), 
-			    scaledDistDir + "/" + name + ".root");
+	  scaled.insert(std::make_pair(name, dists[i].GetHistogram()));
       }
   }
 
   // and also save the data
   if(dataDist.GetHistogram().GetNDims() < 3){
-      IO::SaveHistogram(dataDist.GetHistogram(), scaledDistDir + "/" + "data.root");
+      scaled.insert(std::make_pair(std::string("data"), dataDist.GetHistogram()));
   }else{
       std::vector<std::string> keepObs;
       keepObs.push_back("r");
       keepObs.push_back("energy");
       dataDist = dataDist.Marginalise(keepObs);
-      IO::SaveHistogram(dataDist.GetHistogram(), scaledDistDir + "/" + "data.root");
+      scaled.insert(std::make_pair(std::string("data"), dataDist.GetHistogram()));
   }
+  FitRunner::SaveHists(scaled, scaledDistDir, container);
   // avoid binning again if not nessecary
   IO::SaveHistogram(dataDist.GetHistogram(),  outDir + "/" + "data.h5");
 
   // save autocorrelations
-  std::ofstream cofs((outDir + "/auto_correlations.txt").c_str());
-  std::vector<double> autocors = samples.GetAutoCorrelations();
-  for(size_t i = 0; i < autocors.size(); i++)
-      cofs << i << "\t" << autocors.at(i) << "\n";
-  cofs.close();
+  if(mode_ != "map"){
+      std::ofstream cofs((outDir + "/auto_correlations.txt").c_str());
+      for(size_t i = 0; i < result.fAutoCorrelations.size(); i++)
+          cofs << i << "\t" << result.fAutoCorrelations.at(i) << "\n";
+      cofs.close();
+  }
 
   // and a copy of all of the configurations used
   std::ifstream if_a(mcmcConfigFile_.c_str(), std::ios_base::binary);
@@ -305,21 +166,38 @@ Fit(const std::string& mcmcConfigFile_,
 }
 
 int main(int argc, char *argv[]){
-  if (argc != 6 && argc != 7){
-    std::cout << "\nUsage: fit_dataset <fit_config_file> <dist_config_file> <cut_config_file> <data_to_fit> <4d,3d or 2d> <(opt) outdir_override>" << std::endl;
+  // pull out the options, everything else is positional
+  std::string mode = "mcmc";
+  bool sharePdfs = false;
+  std::string initFrom;
+  std::vector<std::string> args;
+  for(int i = 1; i < argc; i++){
+    std::string arg(argv[i]);
+    if(arg == "--mode" && i + 1 < argc)
+      mode = argv[++i];
+    else if(arg == "--shared-pdfs")
+      sharePdfs = true;
+    else if(arg == "--init-from" && i + 1 < argc)
+      initFrom = argv[++i];
+    else
+      args.push_back(arg);
+  }
+
+  if ((args.size() != 5 && args.size() != 6) || (mode != "mcmc" && mode != "map")){
+    std::cout << "\nUsage: fit_dataset [--mode mcmc|map] [--shared-pdfs] [--init-from <fit_result.txt or fit dir>] <fit_config_file> <dist_config_file> <cut_config_file> <data_to_fit> <4d,3d or 2d> <(opt) outdir_override>" << std::endl;
       return 1;
   }
 
-  std::string fitConfigFile(argv[1]);
-  std::string pdfPath(argv[2]);
-  std::string cutConfigFile(argv[3]);
-  std::string dataPath(argv[4]);
-  std::string dims(argv[5]);
+  std::string fitConfigFile(args.at(0));
+  std::string pdfPath(args.at(1));
+  std::string cutConfigFile(args.at(2));
+  std::string dataPath(args.at(3));
+  std::string dims(args.at(4));
   std::string outDirOverride;
-  if(argc == 7)
-    outDirOverride = std::string(argv[6]);
+  if(args.size() == 6)
+    outDirOverride = args.at(5);
 
-  Fit(fitConfigFile, pdfPath, cutConfigFile, dataPath, dims, outDirOverride);
+  Fit(fitConfigFile, pdfPath, cutConfigFile, dataPath, dims, outDirOverride, mode, sharePdfs, initFrom);
 
   return 0;
 }
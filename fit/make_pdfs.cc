@@ -8,6 +8,8 @@
 #include <BinnedED.h>
 #include <DistFiller.h>
 #include <ROOTNtuple.h>
+#include <DataSetView.hh>
+#include <PdfBundle.hh>
 #include <IO.h>
 #include <DistTools.h>
 #include <TH1D.h>
@@ -18,7 +20,10 @@
 #include <CutFactory.hh>
 #include <CutLog.h>
 #include <HistTools.h>
+#include <OutputContainer.hh>
+#include <WeightedCutLog.hh>
 #include <iostream>
+#include <cstdio>
 using namespace bbfit;
 
 int main(int argc, char *argv[]){
@@ -54,11 +59,12 @@ int main(int argc, char *argv[]){
 
   // and another one for the projections - there will be loads
   std::string projDir = pdfDir + "/projections";
-  if (stat(projDir.c_str(), &st) == -1) {
+  if (!pConfig.GetOutputContainer() && stat(projDir.c_str(), &st) == -1) {
     mkdir(projDir.c_str(), 0700);
   }
   
-  std::cout << "\nSaving projections logs to " << projDir << std::endl;
+  std::cout << "\nSaving projections logs to " 
+            << (pConfig.GetOutputContainer() ? OutputContainer::PathFor(projDir) : projDir) << std::endl;
 
   // load up all the event types we want pdfs for
   typedef std::map<std::string, EventConfig> EvMap;
@@ -70,6 +76,8 @@ int main(int argc, char *argv[]){
   typedef std::vector<CutConfig> CutVec;
   CutConfigLoader cutConfLoader(cutConfigFile);
   CutVec cutConfs = cutConfLoader.LoadActive();
+  bool useCutIndex = cutConfLoader.LoadUseCutIndex();
+  bool adaptiveOrder = cutConfLoader.LoadAdaptiveOrder();
 
 
   CutCollection cutCol;
@@ -85,6 +93,9 @@ int main(int argc, char *argv[]){
     delete cut; // cut col takes its own copy
   }
  
+  // kept for the projections and the bundle
+  std::vector<BinnedED> built;
+
   // now make and fill the pdfs
   for(EvMap::iterator it = toGet.begin(); it != toGet.end(); ++it){    
     std::cout << "Building distribution for " << it->first << std::endl;
@@ -92,20 +103,43 @@ int main(int argc, char *argv[]){
     // monitor the effect of the cuts
     CutLog log(cutCol.GetCutNames());
 
-    // find the dataset
-    DataSet* dataSet;
+    // and the weights, if there are any
+    WeightedCutLog weightedLog(cutCol.GetCutNames());
+    BinnedED sumW2;
+    bool weighted = !pConfig.GetWeight().empty();
+
+    // find the dataset, create and fill
+    BinnedED dist;
+    BinnedED counts;
     try{
-        dataSet = new ROOTNtuple(it->second.GetSplitPdfPath(), "pruned");
+        if(weighted)
+          dist = DistBuilder::BuildWeighted(it->first, pConfig, it->second.GetSplitPdfPath(), 
+                                            cutConfs, log, weightedLog, sumW2, useCutIndex, adaptiveOrder);
+        else if(pConfig.GetKDE())
+          dist = DistBuilder::BuildKDE(it->first, pConfig, it->second.GetSplitPdfPath(), 
+                                       cutConfs, log, counts, useCutIndex, adaptiveOrder);
+        else
+          dist = DistBuilder::Build(it->first, pConfig, it->second.GetSplitPdfPath(), 
+                                    cutConfs, log, useCutIndex, adaptiveOrder);
     }
     catch(const IOError& e_){
         std::cout << "Warning: skipping " << it-> first << " couldn't open data set:\n\t" << e_.what() << std::endl;
         continue;
     }
 
-    // create and fill
-    BinnedED dist = DistBuilder::Build(it->first, pConfig, dataSet, cutCol, log);
-
-    delete dataSet;
+    // the raw counts, for the MC statistical uncertainty in the fit, 
+    // weighted ones need the sum of squares too. The kde's output is smoothed,
+    // the counts come from the fill underneath it
+    if(!pConfig.GetKDE())
+      counts = dist;
+    IO::SaveHistogram(counts.GetHistogram(), pdfDir + "/" + it->first + ".counts.h5");
+    if(weighted){
+      IO::SaveHistogram(sumW2.GetHistogram(), pdfDir + "/" + it->first + ".sumw2.h5");
+      weightedLog.SaveAs(it->first + " weighted by " + pConfig.GetWeight(), 
+                         pdfDir + "/" + it->first + ".weighted.txt");
+    }
+    else
+      remove((pdfDir + "/" + it->first + ".sumw2.h5").c_str()); // stale from a weighted build
 
     // normalise
     if(dist.Integral())
@@ -116,25 +150,19 @@ int main(int argc, char *argv[]){
 
     // save as h5
     IO::SaveHistogram(dist.GetHistogram(), pdfDir + "/" + it->first + ".h5");
+    built.push_back(dist);
 
     // save as a root histogram if possible
     if(dist.GetNDims() <= 2)
         IO::SaveHistogram(dist.GetHistogram(), pdfDir + "/" + it->first + ".root");
+  }
 
-    // HigherD save the projections
-    if(dist.GetNDims() > 1){
-      std::vector<BinnedED> projs = HistTools::GetVisualisableProjections(dist);
-
-      // save them as apropriate
-      for(size_t i = 0; i < projs.size(); i++){
-          const BinnedED& proj = projs.at(i);
+  // HigherD save the projections, computed for all the dists at once
+  OutputContainer::Save(OutputContainer::Projections(built), projDir, pConfig.GetOutputContainer());
 
-          if(projs.at(i).GetNDims() == 1)
-              DistTools::ToTH1D(proj).SaveAs((projDir + "/" + proj.GetName() + ".root").c_str());
-          else
-              DistTools::ToTH2D(proj).SaveAs((projDir + "/" + proj.GetName() + ".root").c_str());
-      }
-    }
+  if(pConfig.GetBundle()){
+    std::cout << "\nWriting pdf bundle " << PdfBundle::BundlePath(pdfDir) << std::endl;
+    PdfBundle::Save(PdfBundle::BundlePath(pdfDir), built);
   }
 
   return 0;
@@ -115,6 +115,16 @@ int main(int argc, char *argv[]){
     const StringVec& files = it->second.GetNtupFiles();
     const std::string& outName = it->second.GetPrunedPath();
 
+    // already written by clean_and_prune, see data_manip/cut_bipos.sh and alphan_cleaning.sh
+    if(it->second.GetPrePruned()){
+      if(stat(outName.c_str(), &st) == -1)
+        std::cout << "Warning: " << name << " is pruned by clean_and_prune but " << outName 
+                  << " doesn't exist yet, run the data_manip scripts first" << std::endl;
+      else
+        std::cout << "Skipping " << name << ", already pruned to " << outName << std::endl;
+      continue;
+    }
+
     std::cout << "Writing from :" << std::endl;
     for(size_t i = 0; i < files.size(); i++)
       std::cout << "\t" << files.at(i) << std::endl;
@@ -0,0 +1,227 @@
+// Profile likelihood scan of one normalisation (0v by default): a conditional
+// minimisation of everything else at each grid point, run in parallel over
+// chunks of the grid with warm starts from the neighbouring point.
+// Writes the delta chi2 curve, an upper limit and the discovery significance
+#include <FitSetup.hh>
+#include <ParameterLayout.hh>
+#include <IndexedBinnedNLLH.hh>
+#include <BoundedBFGS.hh>
+#include <AxisCollection.h>
+#include <BinAxis.h>
+#include <Histogram.h>
+#include <IO.h>
+#include <thread>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <limits>
+#include <sys/stat.h>
+
+using namespace bbfit;
+
+struct ScanPoint{
+  double fValue;
+  double fNLLH;
+  bool   fConverged;
+};
+
+// minimise everything except param_, which is held at value_, starting from x_
+double
+ConditionalFit(const IndexedBinnedNLLH& lh_, const ParameterLayout& layout_, 
+               size_t param_, double value_, std::vector<double>& x_, bool& converged_){
+  BoundedBFGS minimiser(lh_, layout_);
+  minimiser.Fix(param_, value_);
+  double nllh = minimiser.Minimise(x_);
+  converged_ = minimiser.GetConverged();
+  return nllh;
+}
+
+void
+ScanChunk(const IndexedBinnedNLLH& lh_, const ParameterLayout& layout_, size_t param_,
+          std::vector<double> start_, std::vector<ScanPoint>& points_, 
+          size_t first_, size_t last_){
+  // walk away from the point nearest the global best fit
+  // so each fit starts from its neighbour's solution
+  std::vector<double> x = start_;
+  bool forwards = fabs(points_[first_].fValue - start_[param_]) 
+                  <= fabs(points_[last_ - 1].fValue - start_[param_]);
+  for(size_t j = first_; j < last_; j++){
+    ScanPoint& pt = points_[forwards ? j : first_ + last_ - 1 - j];
+    pt.fNLLH = ConditionalFit(lh_, layout_, param_, pt.fValue, x, pt.fConverged);
+  }
+}
+
+// one sided critical value of delta chi2 for confidence level cl_
+double
+CriticalDeltaChi2(double cl_){
+  // invert 0.5 erfc(z/sqrt 2) = 1 - cl by bisection
+  double lo = 0;
+  double hi = 10;
+  for(int i = 0; i < 100; i++){
+    double mid = 0.5 * (lo + hi);
+    if(0.5 * erfc(mid/sqrt(2.)) > 1 - cl_)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  double z = 0.5 * (lo + hi);
+  return z * z;
+}
+
+void
+Scan(const std::string& fitConfigFile_, const std::string& distConfigFile_,
+     const std::string& cutConfigFile_, const std::string& dataPath_,
+     const std::string& dims_, const std::string& outDir_, 
+     const std::string& paramName_, int nPoints_, double cl_, int nThreads_){
+  FitSetup setup(fitConfigFile_, distConfigFile_, cutConfigFile_, dataPath_, dims_);
+  const ParameterLayout& layout = setup.GetLayout();
+  IndexedBinnedNLLH lh = setup.BuildLikelihood();
+  size_t param = layout.GetIndex(paramName_);
+
+  struct stat st = {0};
+  if (stat(outDir_.c_str(), &st) == -1) {
+    mkdir(outDir_.c_str(), 0700);
+  }
+
+  // unconditional fit first
+  std::vector<double> bestFit(layout.GetNParams());
+  for(size_t i = 0; i < bestFit.size(); i++)
+    bestFit[i] = 0.5 * (layout.GetMinima()[i] + layout.GetMaxima()[i]);
+  BoundedBFGS minimiser(lh, layout);
+  double minNLLH = minimiser.Minimise(bestFit);
+  double bestVal = bestFit[param];
+  std::cout << "Best fit " << paramName_ << " = " << bestVal 
+            << "\t -log(lh) = " << minNLLH << std::endl;
+
+  // the grid points are the centres of the configured bins for that parameter
+  double min = layout.GetMinima()[param];
+  double max = layout.GetMaxima()[param];
+  double width = (max - min)/nPoints_;
+  std::vector<ScanPoint> points(nPoints_);
+  for(int i = 0; i < nPoints_; i++)
+    points[i].fValue = min + (i + 0.5) * width;
+  
+  // split the grid into contiguous chunks, one per thread
+  if(nThreads_ < 1)
+    nThreads_ = 1;
+  if(nThreads_ > nPoints_)
+    nThreads_ = nPoints_;
+
+  std::cout << "Scanning " << paramName_ << " over " << nPoints_ << " points with " 
+            << nThreads_ << " threads" << std::endl;
+
+  std::vector<std::thread> threads;
+  size_t chunk = (nPoints_ + nThreads_ - 1)/nThreads_;
+  for(size_t first = 0; first < size_t(nPoints_); first += chunk){
+    size_t last = std::min(first + chunk, size_t(nPoints_));
+    threads.push_back(std::thread(ScanChunk, std::cref(lh), std::cref(layout), param,
+                                  bestFit, std::ref(points), first, last));
+  }
+  for(size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+
+  // a grid point may beat the global fit by the tolerance, take the lower
+  for(size_t i = 0; i < points.size(); i++)
+    if(points[i].fNLLH < minNLLH)
+      minNLLH = points[i].fNLLH;
+
+  // significance of the excess from the fit with no signal, if the box 
+  // doesn't reach 0 the least it allows stands in for it
+  double nullVal = std::max(min, 0.);
+  if(min > 0)
+    std::cout << "Warning: " << paramName_ << " can't be 0, the significance is against " 
+              << paramName_ << " = " << nullVal << " instead" << std::endl;
+  double zeroNLLH = minNLLH;
+  if(bestVal > nullVal){
+    std::vector<double> x = bestFit;
+    bool converged;
+    zeroNLLH = ConditionalFit(lh, layout, param, nullVal, x, converged);
+    if(!converged)
+      std::cout << "Warning: fit at " << paramName_ << " = " << nullVal << " didn't converge" << std::endl;
+  }
+  double q0 = std::max(2 * (zeroNLLH - minNLLH), 0.);
+  double significance = sqrt(q0);
+
+  // upper limit: where delta chi2 crosses the critical value above the best fit
+  double critical = CriticalDeltaChi2(cl_);
+  double upperLimit = std::numeric_limits<double>::quiet_NaN();
+  for(size_t i = 1; i < points.size(); i++){
+    double prev = 2 * (points[i-1].fNLLH - minNLLH);
+    double curr = 2 * (points[i].fNLLH - minNLLH);
+    if(points[i].fValue > bestVal && prev < critical && curr >= critical){
+      upperLimit = points[i-1].fValue + (critical - prev)/(curr - prev) * width;
+      break;
+    }
+  }
+  bool limitReached = !std::isnan(upperLimit);
+  if(!limitReached)
+    std::cout << "Warning: delta chi2 never crosses " << critical << " above the best fit, the " 
+              << "upper limit is past " << max << ", widen the range of " << paramName_ << std::endl;
+
+  // write it all out
+  AxisCollection axes;
+  axes.AddAxis(BinAxis(paramName_, min, max, nPoints_));
+  Histogram curve(axes);
+
+  std::ofstream ofs((outDir_ + "/profile_scan.txt").c_str());
+  ofs << "# " << paramName_ << "\t-log(lh)\tdelta_chi2\tconverged\n";
+  for(size_t i = 0; i < points.size(); i++){
+    double deltaChi2 = 2 * (points[i].fNLLH - minNLLH);
+    curve.SetBinContent(i, deltaChi2);
+    ofs << points[i].fValue << "\t" << points[i].fNLLH << "\t" 
+        << deltaChi2 << "\t" << points[i].fConverged << "\n";
+    if(!points[i].fConverged)
+      std::cout << "Warning: fit at " << points[i].fValue << " didn't converge" << std::endl;
+  }
+  ofs.close();
+  IO::SaveHistogram(curve, outDir_ + "/" + paramName_ + "_delta_chi2.root");
+
+  std::ofstream sofs((outDir_ + "/profile_summary.txt").c_str());
+  sofs << "best_fit\t" << bestVal << "\n"
+       << "min_nllh\t" << minNLLH << "\n"
+       << "upper_limit\t" << upperLimit << "\n"
+       << "upper_limit_reached\t" << limitReached << "\n"
+       << "cl\t" << cl_ << "\n"
+       << "q0\t" << q0 << "\n"
+       << "q0_null\t" << nullVal << "\n"
+       << "significance\t" << significance << "\n";
+  sofs.close();
+
+  if(limitReached)
+    std::cout << "Upper limit is : " << upperLimit << " counts @ " << 100 * cl_ << "% ";
+  else
+    std::cout << "Upper limit @ " << 100 * cl_ << "% not reached, above " << max;
+  std::cout << "\nDiscovery significance : " << significance << " sigma" 
+            << "\nWritten to " << outDir_ << std::endl;
+}
+
+int main(int argc, char *argv[]){
+  std::string param = "0v";
+  int nPoints = 100;
+  double cl = 0.9;
+  int nThreads = std::thread::hardware_concurrency();
+  std::vector<std::string> args;
+  for(int i = 1; i < argc; i++){
+    std::string arg(argv[i]);
+    if(arg == "--param" && i + 1 < argc)
+      param = argv[++i];
+    else if(arg == "--n_points" && i + 1 < argc)
+      std::istringstream(argv[++i]) >> nPoints;
+    else if(arg == "--cl" && i + 1 < argc)
+      std::istringstream(argv[++i]) >> cl;
+    else if(arg == "--threads" && i + 1 < argc)
+      std::istringstream(argv[++i]) >> nThreads;
+    else
+      args.push_back(arg);
+  }
+
+  if(args.size() != 6 || nPoints < 2 || cl <= 0 || cl >= 1){
+    std::cout << "\nUsage: profile_scan [--param 0v] [--n_points 100] [--cl 0.9] [--threads n] <fit_config_file> <dist_config_file> <cut_config_file> <data_to_fit> <4d,3d or 2d> <outdir>" << std::endl;
+    return 1;
+  }
+
+  Scan(args.at(0), args.at(1), args.at(2), args.at(3), args.at(4), args.at(5),
+       param, nPoints, cl, nThreads);
+  return 0;
+}
@@ -0,0 +1,396 @@
+// Expected counts for every combination of cut thresholds on a grid, from one pass
+// over each event type: the scanned observables are filled into fine histograms
+// (other cuts applied as usual), and each threshold combination is then a box
+// sum on their cumulative histogram. With a dist_config and pdf_dir in the scan
+// config's summary the pdfs come the same way, from a second pass over the pdf 
+// half of the split with the pdf axes added to the fine ones. pdfs = best (the
+// default) writes them at the best s/sqrt(b), all at every combination
+#include <EventConfigLoader.hh>
+#include <EventConfig.hh>
+#include <CutConfigLoader.hh>
+#include <CutConfig.hh>
+#include <CutProgram.hh>
+#include <CumulativeHistogram.hh>
+#include <DistConfigLoader.hh>
+#include <DistConfig.hh>
+#include <DistBuilder.hh>
+#include <IO.h>
+#include <sys/stat.h>
+#include <DataSetView.hh>
+#include <ConfigLoader.hh>
+#include <BinnedED.h>
+#include <AxisCollection.h>
+#include <BinAxis.h>
+#include <CutLog.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+
+using namespace bbfit;
+
+struct ScanCut{
+  std::string fName;
+  std::string fObs;
+  bool   fBox;
+  bool   fLower; // line cuts keeping val > threshold
+  double fMin;
+  double fMax;
+  int    fNBins;
+  std::vector<double> fValues;  // line
+  std::vector<double> fLowers;  // box
+  std::vector<double> fUppers;
+};
+
+// one setting of a scanned cut: the cells it keeps and the thresholds it was snapped to
+struct ScanOption{
+  size_t fLowerCell;
+  size_t fUpperCell;
+  std::vector<double> fThresholds;
+};
+
+ScanCut
+LoadScanCut(const std::string& scanConfig_, const std::string& name_, CutConfig cutConf_){
+  ScanCut cut;
+  cut.fName = name_;
+  cut.fObs = cutConf_.GetObs();
+  if(cutConf_.GetType() == "box")
+    cut.fBox = true;
+  else if(cutConf_.GetType() == "line"){
+    cut.fBox = false;
+    cut.fLower = cutConf_.GetValue2() > 0;
+  }
+  else
+    throw ValueError("scan_cuts:: can only scan line and box cuts, " + name_ + " is " + cutConf_.GetType());
+
+  ConfigLoader::Open(scanConfig_);
+  ConfigLoader::Load(name_, "min", cut.fMin);
+  ConfigLoader::Load(name_, "max", cut.fMax);
+  ConfigLoader::Load(name_, "nbins", cut.fNBins);
+  if(cut.fBox){
+    ConfigLoader::Load(name_, "lowers", cut.fLowers);
+    ConfigLoader::Load(name_, "uppers", cut.fUppers);
+  }
+  else
+    ConfigLoader::Load(name_, "values", cut.fValues);
+  ConfigLoader::Close();
+  return cut;
+}
+
+// fine bins over [min, max) plus one cell either side for everything outside
+BinAxis
+FineAxis(const ScanCut& cut_){
+  double width = (cut_.fMax - cut_.fMin)/cut_.fNBins;
+  std::vector<double> lows(1, -1e300);
+  std::vector<double> highs(1, cut_.fMin);
+  for(int i = 0; i < cut_.fNBins; i++){
+    lows.push_back(cut_.fMin + i * width);
+    highs.push_back(cut_.fMin + (i + 1) * width);
+  }
+  lows.push_back(cut_.fMax);
+  highs.push_back(1e300);
+  return BinAxis(cut_.fObs, lows, highs);
+}
+
+// index of the fine bin edge nearest to threshold_
+size_t
+SnapToEdge(const ScanCut& cut_, double threshold_, double& snapped_){
+  double width = (cut_.fMax - cut_.fMin)/cut_.fNBins;
+  long k = lround((threshold_ - cut_.fMin)/width);
+  k = std::max(0L, std::min(long(cut_.fNBins), k));
+  snapped_ = cut_.fMin + k * width;
+  if(std::abs(snapped_ - threshold_) > 1e-6 * width)
+    std::cout << "Warning:: " << cut_.fName << " threshold " << threshold_ 
+              << " moved to the nearest bin edge " << snapped_ << std::endl;
+  return k;
+}
+
+std::vector<ScanOption>
+Options(const ScanCut& cut_){
+  std::vector<ScanOption> options;
+  double snapped;
+  double snapped2;
+  if(!cut_.fBox){
+    for(size_t i = 0; i < cut_.fValues.size(); i++){
+      size_t k = SnapToEdge(cut_, cut_.fValues.at(i), snapped);
+      ScanOption opt;
+      opt.fLowerCell = cut_.fLower ? k + 1 : 0;
+      opt.fUpperCell = cut_.fLower ? cut_.fNBins + 2 : k + 1;
+      opt.fThresholds.push_back(snapped);
+      options.push_back(opt);
+    }
+    return options;
+  }
+
+  for(size_t i = 0; i < cut_.fLowers.size(); i++)
+    for(size_t j = 0; j < cut_.fUppers.size(); j++){
+      if(cut_.fLowers.at(i) >= cut_.fUppers.at(j))
+        continue;
+      ScanOption opt;
+      opt.fLowerCell = SnapToEdge(cut_, cut_.fLowers.at(i), snapped) + 1;
+      opt.fUpperCell = SnapToEdge(cut_, cut_.fUppers.at(j), snapped2) + 1;
+      opt.fThresholds.push_back(snapped);
+      opt.fThresholds.push_back(snapped2);
+      options.push_back(opt);
+    }
+  return options;
+}
+
+// pdf and raw counts for every event type at one threshold combination, as make_pdfs writes them
+void
+SavePdfs(const std::vector<std::string>& names_, const std::vector<CumulativeHistogram>& pdfSums_,
+         const std::vector<size_t>& cutDims_, const std::vector<size_t>& lower_, 
+         const std::vector<size_t>& upper_, const std::string& thresholds_, const std::string& dir_){
+  struct stat st = {0};
+  if(stat(dir_.c_str(), &st) == -1)
+    mkdir(dir_.c_str(), 0700);
+
+  for(size_t i = 0; i < names_.size(); i++){
+    BinnedED counts = pdfSums_.at(i).PdfAt(cutDims_, lower_, upper_, names_.at(i), false);
+    IO::SaveHistogram(counts.GetHistogram(), dir_ + "/" + names_.at(i) + ".counts.h5");
+    BinnedED pdf = counts;
+    if(pdf.Integral())
+      pdf.Normalise();
+    IO::SaveHistogram(pdf.GetHistogram(), dir_ + "/" + names_.at(i) + ".h5");
+  }
+
+  std::ofstream ofs((dir_ + "/scan_thresholds.txt").c_str());
+  ofs << thresholds_ << "\n";
+}
+
+void
+Scan(const std::string& evConfigFile_, const std::string& cutConfigFile_, 
+     const std::string& scanConfigFile_, double liveTime_, const std::string& outFile_){
+  // what to scan
+  std::vector<std::string> scanNames;
+  std::string signal = "0v";
+  std::string distConfigFile;
+  std::string pdfsFor = "best";
+  ConfigLoader::Open(scanConfigFile_);
+  ConfigLoader::Load("summary", "scan", scanNames);
+  try{
+    ConfigLoader::Load("summary", "signal", signal);
+  }
+  catch(const ConfigFieldMissing&){}
+  // the binning comes from dist_config, the pdfs go in their own pdf_dir so 
+  // they don't overwrite make_pdfs' output
+  std::string pdfDir;
+  try{
+    ConfigLoader::Load("summary", "dist_config", distConfigFile);
+    ConfigLoader::Load("summary", "pdf_dir", pdfDir);
+    ConfigLoader::Load("summary", "pdfs", pdfsFor);
+  }
+  catch(const ConfigFieldMissing&){}
+  ConfigLoader::Close();
+  if(!distConfigFile.empty() && pdfDir.empty())
+    throw ValueError("scan_cuts:: dist_config needs a pdf_dir for the pdfs to go in");
+  if(pdfsFor != "best" && pdfsFor != "all")
+    throw ValueError("scan_cuts:: pdfs can be written for the best or all threshold combinations, not " + pdfsFor);
+
+  // the cuts not being scanned are applied while filling
+  std::vector<CutConfig> fixedCuts;
+  std::vector<CutConfig> scanCutConfs;
+  {
+    CutConfigLoader cutLoader(cutConfigFile_);
+    std::vector<CutConfig> allCuts = cutLoader.LoadActive();
+    for(size_t i = 0; i < allCuts.size(); i++)
+      if(std::find(scanNames.begin(), scanNames.end(), allCuts.at(i).GetName()) == scanNames.end())
+        fixedCuts.push_back(allCuts.at(i));
+    for(size_t i = 0; i < scanNames.size(); i++)
+      scanCutConfs.push_back(cutLoader.LoadOne(scanNames.at(i)));
+  }
+
+  std::vector<ScanCut> scanCuts;
+  for(size_t i = 0; i < scanNames.size(); i++)
+    scanCuts.push_back(LoadScanCut(scanConfigFile_, scanNames.at(i), scanCutConfs.at(i)));
+
+  AxisCollection axes;
+  std::vector<std::string> observables;
+  for(size_t i = 0; i < scanCuts.size(); i++){
+    if(std::find(observables.begin(), observables.end(), scanCuts.at(i).fObs) != observables.end())
+      throw ValueError("scan_cuts:: two scanned cuts on " + scanCuts.at(i).fObs);
+    axes.AddAxis(FineAxis(scanCuts.at(i)));
+    observables.push_back(scanCuts.at(i).fObs);
+  }
+  CutProgram fixed(fixedCuts);
+
+  // the pdf axes go after the scanned ones, a scanned observable can't also
+  // be binned for the pdf, its cells are the cut
+  bool makePdfs = !distConfigFile.empty();
+  DistConfig distConfig;
+  AxisCollection pdfAxes = axes;
+  std::vector<std::string> pdfObservables = observables;
+  std::vector<size_t> cutDims;
+  for(size_t i = 0; i < scanCuts.size(); i++)
+    cutDims.push_back(i);
+  if(makePdfs){
+    struct stat st = {0};
+    if(stat(pdfDir.c_str(), &st) == -1)
+      mkdir(pdfDir.c_str(), 0700);
+    distConfig = DistConfigLoader(distConfigFile).Load();
+    AxisCollection distAxes = DistBuilder::BuildAxes(distConfig);
+    const std::vector<std::string>& branches = distConfig.GetBranchNames();
+    for(size_t i = 0; i < branches.size(); i++){
+      if(std::find(observables.begin(), observables.end(), branches.at(i)) != observables.end())
+        throw ValueError("scan_cuts:: " + branches.at(i) + " is both scanned and a pdf axis");
+      pdfAxes.AddAxis(distAxes.GetAxis(i));
+      pdfObservables.push_back(branches.at(i));
+    }
+  }
+
+  // one pass per event type
+  typedef std::map<std::string, EventConfig> EvMap;
+  EventConfigLoader loader(evConfigFile_);
+  EvMap toGet = loader.LoadActive();
+
+  std::vector<std::string> names;
+  std::vector<CumulativeHistogram> sums;
+  std::vector<CumulativeHistogram> pdfSums;
+  std::vector<double> scales;
+  for(EvMap::iterator it = toGet.begin(); it != toGet.end(); ++it){
+    if(!it->second.GetRate())
+      continue;
+    std::cout << "Filling " << it->first << std::endl;
+
+    DataSet* data = DataSetView::Open(it->second.GetPrunedPath(), "pruned");
+    BinnedED dist(it->first, axes);
+    dist.SetObservables(observables);
+    CutLog log(fixed.GetCutNames());
+    fixed.Fill(dist, *data, log);
+
+    // as in build_azimov
+    double nGen = data->GetNEntries();
+    if(it->second.GetNGenerated())
+      nGen = it->second.GetNGenerated();
+    delete data;
+
+    names.push_back(it->first);
+    sums.push_back(CumulativeHistogram(dist));
+    scales.push_back(nGen ? liveTime_ * it->second.GetRate()/nGen : 0);
+
+    // the pdfs come from the same events make_pdfs would use
+    if(!makePdfs)
+      continue;
+    DataSet* pdfData = DataSetView::Open(it->second.GetSplitPdfPath(), "pruned");
+    BinnedED pdfDist(it->first, pdfAxes);
+    pdfDist.SetObservables(pdfObservables);
+    CutLog pdfLog(fixed.GetCutNames());
+    fixed.Fill(pdfDist, *pdfData, pdfLog);
+    delete pdfData;
+    pdfSums.push_back(CumulativeHistogram(pdfDist));
+  }
+
+  if(std::find(names.begin(), names.end(), signal) == names.end())
+    throw NotFoundError("scan_cuts:: signal " + signal + " isn't an active event type with a rate");
+
+  // every combination of the options, odometer style
+  std::vector<std::vector<ScanOption> > options;
+  for(size_t i = 0; i < scanCuts.size(); i++){
+    options.push_back(Options(scanCuts.at(i)));
+    if(options.back().empty())
+      throw ValueError("scan_cuts:: nothing to scan for " + scanCuts.at(i).fName);
+  }
+
+  std::ofstream ofs(outFile_.c_str());
+  ofs << "#";
+  for(size_t i = 0; i < scanCuts.size(); i++){
+    if(scanCuts.at(i).fBox)
+      ofs << "\t" << scanCuts.at(i).fName << "_low\t" << scanCuts.at(i).fName << "_high";
+    else
+      ofs << "\t" << scanCuts.at(i).fName;
+  }
+  ofs << "\tsignal\tbackground\ts_over_sqrt_b";
+  for(size_t i = 0; i < names.size(); i++)
+    ofs << "\t" << names.at(i);
+  ofs << "\n";
+
+  std::vector<size_t> choice(scanCuts.size(), 0);
+  std::vector<size_t> lower(scanCuts.size());
+  std::vector<size_t> upper(scanCuts.size());
+  std::vector<double> counts(names.size());
+  double bestFom = -1;
+  std::string best;
+  std::vector<size_t> bestLower;
+  std::vector<size_t> bestUpper;
+  size_t nCombinations = 0;
+  while(true){
+    for(size_t i = 0; i < choice.size(); i++){
+      lower[i] = options[i][choice[i]].fLowerCell;
+      upper[i] = options[i][choice[i]].fUpperCell;
+    }
+
+    double sig = 0;
+    double bkg = 0;
+    for(size_t i = 0; i < names.size(); i++){
+      counts[i] = scales[i] * sums[i].Sum(lower, upper);
+      if(names.at(i) == signal)
+        sig += counts[i];
+      else
+        bkg += counts[i];
+    }
+    double fom = bkg > 0 ? sig/sqrt(bkg) : 0;
+
+    std::ostringstream row;
+    for(size_t i = 0; i < choice.size(); i++){
+      const std::vector<double>& th = options[i][choice[i]].fThresholds;
+      for(size_t j = 0; j < th.size(); j++)
+        row << th.at(j) << "\t";
+    }
+    ofs << row.str() << sig << "\t" << bkg << "\t" << fom;
+    for(size_t i = 0; i < counts.size(); i++)
+      ofs << "\t" << counts[i];
+    ofs << "\n";
+    nCombinations++;
+
+    if(fom > bestFom){
+      bestFom = fom;
+      best = row.str();
+      bestLower = lower;
+      bestUpper = upper;
+    }
+
+    // numbered by row of the table
+    if(makePdfs && pdfsFor == "all"){
+      std::ostringstream dir;
+      dir << pdfDir << "/" << nCombinations - 1;
+      SavePdfs(names, pdfSums, cutDims, lower, upper, row.str(), dir.str());
+    }
+
+    // next combination
+    size_t d = 0;
+    for(; d < choice.size(); d++){
+      if(++choice[d] < options[d].size())
+        break;
+      choice[d] = 0;
+    }
+    if(d == choice.size())
+      break;
+  }
+  ofs.close();
+
+  std::cout << "Written " << nCombinations << " threshold combinations to " << outFile_ 
+            << "\nBest s/sqrt(b) = " << bestFom << " at " << best << std::endl;
+
+  if(makePdfs && pdfsFor == "best"){
+    SavePdfs(names, pdfSums, cutDims, bestLower, bestUpper, best, pdfDir);
+    std::cout << "Saved the pdfs at the best thresholds to " << pdfDir << std::endl;
+  }
+  else if(makePdfs)
+    std::cout << "Saved the pdfs at every combination to " << pdfDir 
+              << "/<row of the table>" << std::endl;
+}
+
+int main(int argc, char *argv[]){
+  if(argc != 6){
+    std::cout << "\nUsage: scan_cuts <event_config_file> <cut_config_file> <scan_config_file> <live_time(yr)> <out_file>" << std::endl;
+    return 1;
+  }
+  double liveTime;
+  std::istringstream(argv[4]) >> liveTime;
+
+  Scan(argv[1], argv[2], argv[3], liveTime, argv[5]);
+  return 0;
+}
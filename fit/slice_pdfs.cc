@@ -13,6 +13,7 @@
 #include <FitConfig.hh>
 #include <FitConfigLoader.hh>
 #include <HistTools.h>
+#include <OutputContainer.hh>
 #include <iostream>
 using namespace bbfit;
 
@@ -40,38 +41,32 @@ int main(int argc, char *argv[]){
   // create directory for the slices - there will be loads
 	struct stat st = {0};
   std::string sliceDir = pdfDir + "/slices";
-  if (stat(sliceDir.c_str(), &st) == -1) {
+  if (!pConfig.GetOutputContainer() && stat(sliceDir.c_str(), &st) == -1) {
     mkdir(sliceDir.c_str(), 0700);
   }
   
-  std::cout << "\nSaving slices to " << sliceDir << std::endl;
+  std::cout << "\nSaving slices to " 
+            << (pConfig.GetOutputContainer() ? OutputContainer::PathFor(sliceDir) : sliceDir) << std::endl;
 
 
   // want slices for the pdfs that are use in the fit, i.e. in mcmcconfig
 	FitConfigLoader mcLoader(fitConfigFile);
 	FitConfig fConfig = mcLoader.LoadActive();
   typedef std::set<std::string> StringSet;
-  StringSet distsToFit = fConfig.GetParamNames();
+  StringSet distsToFit = fConfig.GetDistNames();
 
 	
+  std::vector<BinnedED> dists;
   for(StringSet::iterator it = distsToFit.begin(); it != distsToFit.end();
       ++it){
     std::string distPath = pdfDir + "/" + *it + ".h5";
     BinnedED dist = BinnedED(*it, IO::LoadHistogram(distPath));
 		dist.SetObservables(pConfig.GetBranchNames());
-		
-    // only get slices for higher D
-    if(dist.GetNDims() > 1){
-      std::vector<BinnedED> slices = HistTools::Get1DSlices(dist, "energy");
-
-      // save them as apropriate
-      for(size_t i = 0; i < slices.size(); i++){
-          const BinnedED& slice = slices.at(i);
-					DistTools::ToTH1D(slice).SaveAs((sliceDir + "/" + slice.GetName() + ".root").c_str());
-          
-      }
-    }
+    dists.push_back(dist);
   }
 
+  // only higher D get slices, all sliced at once
+  OutputContainer::Save(OutputContainer::Slices(dists, "energy"), sliceDir, pConfig.GetOutputContainer());
+
   return 0;
 }
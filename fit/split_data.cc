@@ -2,9 +2,8 @@
 #include <EventConfig.hh>
 #include <iostream>
 #include <IO.h>
-#include <ROOTNtuple.h>
-#include <DataSetGenerator.h>
-#include <OXSXDataSet.h>
+#include <DataSetView.hh>
+#include <StreamingDataSetGenerator.hh>
 #include <sstream>
 #include <fstream>
 #include <Formatter.hpp>
@@ -13,7 +12,7 @@
 #include <Rand.h>
 using namespace bbfit;
 
-void SaveRemainders(DataSetGenerator &dsGen, std::vector<DataSet*> &dataSets, std::vector<std::string> &names, const std::string &configFile_){
+void SaveRemainders(StreamingDataSetGenerator &dsGen, std::vector<std::string> &names, const std::string &configFile_){
 
   std::string outDirPdf;
   ConfigLoader::Open(configFile_);
@@ -25,19 +24,12 @@ void SaveRemainders(DataSetGenerator &dsGen, std::vector<DataSet*> &dataSets, st
     mkdir(outDirPdf.c_str(), 0700);
   }
 	
-  // save what's left over as independent data sets
-  OXSXDataSet* remainder = NULL;
-  int countsTaken = 0;
+  // save what's left over as independent data sets, these are just the unused entry numbers
   std::vector<int> content;
-  for(int iSet = 0; iSet < dataSets.size(); iSet++){
-    std::cout << "Assembling the remainder for  " << names.at(iSet) << std::endl;
-
-    remainder = dsGen.AllRemainingEvents(iSet, &countsTaken);
-    content.push_back(countsTaken);
-    
-    std::cout << "\t.. and saving" << std::endl;
-    IO::SaveDataSet(*remainder, Formatter() << outDirPdf << "/" << names.at(iSet) << ".root", "pruned");		
-    delete remainder;
+  for(size_t iSet = 0; iSet < names.size(); iSet++){
+    std::cout << "Saving the remainder for  " << names.at(iSet) << std::endl;
+    std::string outPath = Formatter() << outDirPdf << "/" << names.at(iSet) << ".root";
+    content.push_back(dsGen.SaveRemainder(iSet, DataSetView::IndexPath(outPath)));
   }
 
   std::ofstream fs;
@@ -58,58 +50,34 @@ MakeDataSets(const std::string& configFile_, double liveTime_, int nDataSets_, b
   typedef std::map<std::string, EventConfig>  EvMap;
   EvMap active = loader.LoadActive();
  
-  // pull out the useful parts
+  // pull out the useful parts, the events themselves are only read when they're drawn
   std::vector<std::string> names;
-  std::vector<double> rates;
-  std::vector<DataSet*> dataSets;
-  std::vector<bool> flags;
-  std::vector<bool> bootstraps;
+  StreamingDataSetGenerator dsGen;
 	
   for(EvMap::iterator it = active.begin(); it != active.end(); ++it){
-    DataSet* ds = new ROOTNtuple(it->second.GetPrunedPath(), "pruned");
+    DataSet* ds = DataSetView::Open(it->second.GetPrunedPath(), "pruned");
+    unsigned nEntries = ds->GetNEntries();
+    delete ds;
+
     // note the correction for the number of events generated e.g scintEdep cut
     double expectedCounts = it->second.GetRate() * liveTime_;
     
     if(it->second.GetNGenerated())
-      expectedCounts *= ds->GetNEntries()/double(it->second.GetNGenerated());
+      expectedCounts *= nEntries/double(it->second.GetNGenerated());
 
     if(!expectedCounts)
-      std::cout << "\n(" << ds->GetNEntries() << "\t" << it->second.GetNGenerated() << "\t" << liveTime_ << "\t" << it->second.GetRate() << ")\n" << std::endl;
+      std::cout << "\n(" << nEntries << "\t" << it->second.GetNGenerated() << "\t" << liveTime_ << "\t" << it->second.GetRate() << ")\n" << std::endl;
 
-    if(!ds->GetNEntries()){
+    if(!nEntries){
       std::cout << "Warning:: skipping " << it->first << "  no events to choose from" << std::endl;
       continue;
     }
 
     //Rand::SetSeed(0);
 
-    dataSets.push_back(ds);
     names.push_back(it->first);
-    rates.push_back(expectedCounts);
-    flags.push_back(!it->second.GetRandomSplit());
-    bootstraps.push_back(replaceEvents_);
-
-    //Could use the below instead of the line above to make sure to just replace events with low stats
-    //This creates somewhat semi-independent datasets though!!!
-    /*
-    std::cout<< "Name: " << (it->first).c_str() <<std::endl;
-    if ( ((it->first)=="tl208_av") ||
-	 ((it->first)=="tl208_hup") ||
-				 ((it->first)=="tl208_hdr") ||
-				 ((it->first)=="tl208_exwater") ||
-				 ((it->first)=="bi214_av") ||
-				 ((it->first)=="bi214_od") ||
-				 ((it->first)=="bi214_exwater")
-			){
-			bootstraps.push_back(1);
-			std::cout<< "Overring bootstrap! " <<std::endl;
-		
-		}else{
-			bootstraps.push_back(replaceEvents_);
-		}
-
-		std::cout<< "Name: " << it->first <<std::endl;
-    */
+    dsGen.AddDataSet(it->first, it->second.GetPrunedPath(), expectedCounts, 
+                     !it->second.GetRandomSplit(), replaceEvents_);
 
     std::cout << "Loading data set " 
 	      << it->second.GetPrunedPath() 
@@ -118,12 +86,6 @@ MakeDataSets(const std::string& configFile_, double liveTime_, int nDataSets_, b
 	      << "\n";
 
 	}
-
-  DataSetGenerator dsGen;
-  dsGen.SetDataSets(dataSets);
-  dsGen.SetExpectedRates(rates);
-  dsGen.SetSequentialFlags(flags);
-  dsGen.SetBootstrap(bootstraps);
 		
 	
   std::string outDirFake;
@@ -139,30 +101,26 @@ MakeDataSets(const std::string& configFile_, double liveTime_, int nDataSets_, b
   std::cout << "Generating " << nDataSets_ << " data sets with livetime " << liveTime_
 	    << "  including poisson fluctuations...\n" << std::endl;
 
-  // actually generate the events
+  // actually generate the events, straight to disk
   std::vector<int> content;
   for(int iSet = 0; iSet < nDataSets_; iSet++){
     std::cout << "DataSet #" << iSet << std::endl;
     std::string outPath = Formatter() << outDirFake << "/fake_data_lt_" << liveTime_ << "__" << iSet;
 
-    //OXSXDataSet ds = dsGen.ExpectedRatesDataSet(&content);
-    OXSXDataSet ds = dsGen.PoissonFluctuatedDataSet(&content);
+    size_t nEvents = dsGen.PoissonFluctuatedDataSet(outPath + ".root", &content);
     std::ofstream fs;
     fs.open((outPath + ".txt").c_str());
     for(size_t i = 0; i < names.size(); i++)
       fs << names.at(i) << "\t" << content.at(i) << "\n";
     fs.close();
 
-    // save to a new ROOT tree
-    IO::SaveDataSet(ds, outPath + ".root", "pruned");
-
-    std::cout << "\t .. written " << ds.GetNEntries() << " events to "  << outPath + ".root"
+    std::cout << "\t .. written " << nEvents << " events to "  << outPath + ".root"
 	      << "\t with logfile " << outPath + ".txt\n\n" << std::endl;
   }
 
 	//If events not replaced, save the remainders, otherwise it doesn't make sense
 	if (!replaceEvents_)
-		SaveRemainders(dsGen, dataSets, names, configFile_);
+		SaveRemainders(dsGen, names, configFile_);
 
 }
 
@@ -7,62 +7,31 @@
 #include <EventConfigLoader.hh>
 #include <EventConfig.hh>
 #include <ConfigLoader.hh>
+#include <DataSetView.hh>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 using namespace bbfit;
 
 void CreateFolder(const std::string& dirname);
 
+// no copies, just write down which entries go where
 void 
 SplitInTwo(const std::string& filename, const std::string& outdir1, const std::string& outdir2, double frac){
     TFile f(filename.c_str());
     TNtuple* c = (TNtuple*)f.Get("pruned");
+    size_t nEntries = c->GetEntries();
 
-    Float_t energy;
-    Float_t fitValid;
-    Float_t reff;
-    Float_t qmcdep;
-    Float_t bipoCumul;
-    Float_t bipolh;
-    Float_t itr;
-		Float_t timePSD;
-		Float_t anglePSD;
+    // the first frac of the entries go to the first
+    frac = std::min(std::max(frac, 0.), 1.);
+    size_t nFirst = std::min(nEntries, size_t(std::ceil(frac * nEntries)));
 
-    c->SetBranchAddress("energy", &energy);
-    c->SetBranchAddress("fitValid", &fitValid);
-    c->SetBranchAddress("reff", &reff);
-    c->SetBranchAddress("qmcdep", &qmcdep);
-    c->SetBranchAddress("bipoCumul", &bipoCumul);
-    c->SetBranchAddress("biPoLikelihood214", &bipolh);
-    c->SetBranchAddress("itr", &itr);
-    c->SetBranchAddress("timePSD", &timePSD);
-    c->SetBranchAddress("anglePSD", &anglePSD);
-    
-    std::cout << outdir1 << std::endl;
-    TFile output1(outdir1.c_str(), "RECREATE");
-    TNtuple* newTree1 = new TNtuple("pruned", "", "energy:fitValid:reff:qmcdep:bipoCumul:biPoLikelihood214:itr:timePSD:anglePSD");
-
-
-    TFile output2(outdir2.c_str(), "RECREATE");
-    TNtuple* newTree2 = new TNtuple("pruned", "", "energy:fitValid:reff:qmcdep:bipoCumul:biPoLikelihood214:itr:timePSD:anglePSD");
-
-    for(int i = 0; i < c->GetEntries(); i++){
-        c->GetEntry(i);
-        Float_t fillVals[] = {energy, fitValid, reff, qmcdep, bipoCumul, bipolh, itr, timePSD, anglePSD};
-        if(1. * i/c->GetEntries() < frac){
-            newTree1->Fill(fillVals);
-        }
-        else{
-            newTree2->Fill(fillVals);
-        }
-    }
-        
-    output1.cd();
-    newTree1->Write();
-    output1.Close();
+    EntryRanges first(1, std::make_pair(size_t(0), nFirst));
+    EntryRanges second(1, std::make_pair(nFirst, nEntries));
 
-    output2.cd();
-    newTree2->Write();
-    output2.Close();
+    std::cout << DataSetView::IndexPath(outdir1) << std::endl;
+    DataSetView::Save(DataSetView::IndexPath(outdir1), filename, first);
+    DataSetView::Save(DataSetView::IndexPath(outdir2), filename, second);
 }
 
 void CreateFolder(const std::string& dirname){
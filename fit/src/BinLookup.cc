@@ -0,0 +1,92 @@
+#include <BinLookup.hh>
+#include <AxisCollection.h>
+#include <BinnedED.h>
+#include <DataSet.h>
+#include <Exceptions.h>
+#include <algorithm>
+#include <cmath>
+
+namespace bbfit{
+
+// past this the axis has a freakishly narrow bin, give it a coarser table and
+// let the step at the end walk further
+static const size_t kMaxCells = 1 << 20;
+
+BinLookup::BinLookup(const AxisCollection& axes_){
+  size_t nDims = axes_.GetNDimensions();
+  for(size_t d = 0; d < nDims; d++){
+    const BinAxis& binAxis = axes_.GetAxis(d);
+    Axis axis;
+    double narrowest = binAxis.GetBinWidth(0);
+    for(size_t b = 0; b < binAxis.GetNBins(); b++){
+      axis.fLowEdges.push_back(binAxis.GetBinLowEdge(b));
+      axis.fHighEdges.push_back(binAxis.GetBinHighEdge(b));
+      narrowest = std::min(narrowest, binAxis.GetBinWidth(b));
+    }
+    axis.fMin = binAxis.GetMinimum();
+    double range = binAxis.GetMaximum() - axis.fMin;
+    // cap in double, open ended axes like scan_cuts' +-1e300 edges are far past
+    // what a size_t holds. A nan range fails the comparison and gets the cap too
+    double cells = narrowest > 0 ? std::ceil(range/narrowest) : 1;
+    size_t nCells = cells < double(kMaxCells) ? size_t(cells) : kMaxCells;
+    nCells = std::max(nCells, size_t(1));
+    axis.fCellWidth = range/nCells;
+
+    size_t bin = 0;
+    for(size_t c = 0; c < nCells; c++){
+      double low = axis.fMin + c * axis.fCellWidth;
+      while(bin + 1 < axis.fHighEdges.size() && low >= axis.fHighEdges[bin])
+        bin++;
+      axis.fCells.push_back(bin);
+    }
+    fAxes.push_back(axis);
+
+    std::vector<size_t> unit(nDims, 0);
+    unit[d] = 1;
+    fStrides.push_back(axes_.FlattenIndices(unit));
+  }
+}
+
+size_t
+BinLookup::FindAxisBin(size_t axis_, double value_) const{
+  const Axis& axis = fAxes[axis_];
+  size_t nBins = axis.fLowEdges.size();
+  if(value_ < axis.fMin)
+    return 0;
+  if(value_ >= axis.fHighEdges[nBins - 1])
+    return nBins - 1;
+
+  size_t cell = std::min(size_t((value_ - axis.fMin)/axis.fCellWidth), axis.fCells.size() - 1);
+  size_t bin = axis.fCells[cell];
+
+  // one step almost always, more only for rounding or a capped table
+  while(bin + 1 < nBins && value_ >= axis.fHighEdges[bin])
+    bin++;
+  while(bin > 0 && value_ < axis.fLowEdges[bin])
+    bin--;
+  return bin;
+}
+
+size_t
+BinLookup::FindBin(const std::vector<double>& values_, const std::vector<size_t>& indices_) const{
+  size_t bin = 0;
+  for(size_t d = 0; d < fAxes.size(); d++)
+    bin += FindAxisBin(d, values_[indices_[d]]) * fStrides[d];
+  return bin;
+}
+
+std::vector<size_t>
+BinLookup::Resolve(const BinnedED& dist_, const DataSet& data_){
+  std::vector<std::string> obs = data_.GetObservableNames();
+  std::vector<std::string> wanted = dist_.GetObservables();
+  std::vector<size_t> indices;
+  for(size_t i = 0; i < wanted.size(); i++){
+    std::vector<std::string>::iterator it = std::find(obs.begin(), obs.end(), wanted.at(i));
+    if(it == obs.end())
+      throw NotFoundError("BinLookup:: data set has no observable " + wanted.at(i) + " to bin");
+    indices.push_back(it - obs.begin());
+  }
+  return indices;
+}
+
+}
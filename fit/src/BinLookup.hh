@@ -0,0 +1,40 @@
+// Constant time bin finding for fills, uniform or variable width axes alike.
+// Each axis gets a table of equal cells no wider than its narrowest bin, so a
+// cell holds at most one bin edge: the table gives the bin at the cell's low
+// edge and one comparison settles it. Values outside an axis go to its edge
+// bins, the same as BinAxis::FindBin
+#ifndef __BBFIT__BinLookup__
+#define __BBFIT__BinLookup__
+#include <vector>
+#include <cstddef>
+
+class AxisCollection;
+class BinnedED;
+class DataSet;
+
+namespace bbfit{
+class BinLookup{
+public:
+  BinLookup(const AxisCollection& axes_);
+
+  size_t FindAxisBin(size_t axis_, double value_) const;
+
+  // flat bin for an event, axis d's value is values_[indices_[d]]
+  size_t FindBin(const std::vector<double>& values_, const std::vector<size_t>& indices_) const;
+
+  // where dist_'s observables are in data_'s events
+  static std::vector<size_t> Resolve(const BinnedED& dist_, const DataSet& data_);
+
+private:
+  struct Axis{
+    double fMin;
+    double fCellWidth;
+    std::vector<double> fLowEdges;
+    std::vector<double> fHighEdges;
+    std::vector<unsigned> fCells; // bin at each cell's low edge
+  };
+  std::vector<Axis>   fAxes;
+  std::vector<size_t> fStrides;
+};
+}
+#endif
@@ -0,0 +1,138 @@
+#include <BinnedKDE.hh>
+#include <BinnedED.h>
+#include <AxisCollection.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <complex>
+#include <cmath>
+
+namespace bbfit{
+
+typedef std::complex<double> Complex;
+
+// in place radix-2, size must be a power of 2
+static void
+FFT(std::vector<Complex>& a_, bool inverse_){
+  size_t n = a_.size();
+  for(size_t i = 1, j = 0; i < n; i++){
+    size_t bit = n >> 1;
+    for(; j & bit; bit >>= 1)
+      j ^= bit;
+    j ^= bit;
+    if(i < j)
+      std::swap(a_[i], a_[j]);
+  }
+
+  for(size_t len = 2; len <= n; len <<= 1){
+    double angle = 2 * M_PI / len * (inverse_ ? 1 : -1);
+    Complex wLen(cos(angle), sin(angle));
+    for(size_t i = 0; i < n; i += len){
+      Complex w(1);
+      for(size_t j = 0; j < len/2; j++){
+        Complex u = a_[i + j];
+        Complex v = a_[i + j + len/2] * w;
+        a_[i + j] = u + v;
+        a_[i + j + len/2] = u - v;
+        w *= wLen;
+      }
+    }
+  }
+
+  if(inverse_)
+    for(size_t i = 0; i < n; i++)
+      a_[i] /= n;
+}
+
+void
+BinnedKDE::ConvolveLane(double* first_, size_t n_, size_t stride_, double sigma_){
+  // the kernel out to 4 sigma, padded so the convolution doesn't wrap
+  size_t half = std::ceil(4 * sigma_);
+  size_t size = 1;
+  while(size < n_ + half + 1)
+    size <<= 1;
+
+  std::vector<double> kernel(half + 1);
+  double kernelSum = 0;
+  for(size_t k = 0; k <= half; k++){
+    kernel[k] = exp(-0.5 * k * k / (sigma_ * sigma_));
+    kernelSum += k ? 2 * kernel[k] : kernel[k];
+  }
+
+  std::vector<Complex> kernelFT(size, 0);
+  for(size_t k = 0; k <= half; k++){
+    kernelFT[k] = kernel[k]/kernelSum;
+    if(k)
+      kernelFT[size - k] = kernel[k]/kernelSum;
+  }
+  FFT(kernelFT, false);
+
+  std::vector<Complex> lane(size, 0);
+  for(size_t i = 0; i < n_; i++)
+    lane[i] = first_[i * stride_];
+  FFT(lane, false);
+  for(size_t i = 0; i < size; i++)
+    lane[i] *= kernelFT[i];
+  FFT(lane, true);
+
+  // how much of the kernel centred on each bin lies inside the range
+  for(size_t i = 0; i < n_; i++){
+    double inside = 0;
+    for(size_t k = 0; k <= half; k++){
+      if(i >= k)
+        inside += kernel[k];
+      if(k && i + k < n_)
+        inside += kernel[k];
+    }
+    first_[i * stride_] = lane[i].real() * kernelSum / inside;
+  }
+}
+
+BinnedED
+BinnedKDE::Estimate(const BinnedED& fine_, const AxisCollection& coarse_,
+                    const std::vector<double>& bandwidths_){
+  const AxisCollection& fineAxes = fine_.GetAxes();
+  size_t nDims = coarse_.GetNDimensions();
+  if(fineAxes.GetNDimensions() != nDims || bandwidths_.size() != nDims)
+    throw DimensionError(Formatter() << "BinnedKDE:: " << nDims << " coarse axes but " 
+                         << fineAxes.GetNDimensions() << " fine axes and " 
+                         << bandwidths_.size() << " bandwidths");
+
+  std::vector<size_t> oversample(nDims);
+  for(size_t d = 0; d < nDims; d++){
+    size_t nFine   = fineAxes.GetAxis(d).GetNBins();
+    size_t nCoarse = coarse_.GetAxis(d).GetNBins();
+    if(nFine % nCoarse)
+      throw DimensionError(Formatter() << "BinnedKDE:: " << nFine << " fine bins don't divide into " 
+                           << nCoarse << " on axis " << coarse_.GetAxis(d).GetName());
+    oversample[d] = nFine / nCoarse;
+  }
+
+  std::vector<double> contents = fine_.GetBinContents();
+  for(size_t d = 0; d < nDims; d++){
+    const BinAxis& axis = fineAxes.GetAxis(d);
+    double sigma = bandwidths_.at(d) / axis.GetBinWidth(0);
+    if(sigma <= 0 || contents.empty())
+      continue;
+
+    std::vector<size_t> unit(nDims, 0);
+    unit[d] = 1;
+    size_t stride = fineAxes.FlattenIndices(unit);
+    size_t n = axis.GetNBins();
+    size_t nLanes = contents.size() / n;
+    for(size_t l = 0; l < nLanes; l++)
+      ConvolveLane(&contents[(l / stride) * stride * n + l % stride], n, stride, sigma);
+  }
+
+  // and back on to the coarse bins
+  BinnedED coarse(fine_.GetName(), coarse_);
+  coarse.SetObservables(fine_.GetObservables());
+  std::vector<size_t> indices(nDims);
+  for(size_t i = 0; i < contents.size(); i++){
+    for(size_t d = 0; d < nDims; d++)
+      indices[d] = fineAxes.UnflattenIndex(i, d) / oversample[d];
+    coarse.AddBinContent(coarse_.FlattenIndices(indices), contents[i]);
+  }
+  return coarse;
+}
+
+}
@@ -0,0 +1,25 @@
+// Gaussian kernel density estimate on a grid: events are filled into a fine
+// histogram, which is convolved with a separable gaussian, one FFT per lane
+// per axis, and summed back onto the coarse bins. Each axis is divided by the
+// kernel mass that fell inside the range, so the edges aren't pulled down
+#ifndef __BBFIT__BinnedKDE__
+#define __BBFIT__BinnedKDE__
+#include <vector>
+#include <cstddef>
+
+class BinnedED;
+class AxisCollection;
+
+namespace bbfit{
+class BinnedKDE{
+public:
+  // fine_ must have a whole number of bins for each bin of coarse_, bandwidths_ 
+  // are sigmas in the units of each axis, 0 leaves that axis alone
+  static BinnedED Estimate(const BinnedED& fine_, const AxisCollection& coarse_,
+                           const std::vector<double>& bandwidths_);
+
+  // n_ values stride_ apart, in place. sigma_ in bins
+  static void ConvolveLane(double* first_, size_t n_, size_t stride_, double sigma_);
+};
+}
+#endif
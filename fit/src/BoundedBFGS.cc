@@ -0,0 +1,225 @@
+#include <BoundedBFGS.hh>
+#include <IndexedLikelihood.hh>
+#include <Exceptions.h>
+#include <algorithm>
+#include <cmath>
+
+namespace bbfit{
+
+BoundedBFGS::BoundedBFGS(const IndexedLikelihood& lh_, const ParameterLayout& layout_) 
+  : fLH(lh_), fLayout(layout_), fMaxIter(1000), fTolerance(1e-8), 
+    fConverged(false), fIterations(0){
+  if(fLH.GetNParams() != fLayout.GetNParams())
+    throw DimensionError(Formatter() << "BoundedBFGS::likelihood has " << fLH.GetNParams()
+                         << " parameters, layout has " << fLayout.GetNParams());
+  fFixed.resize(fLayout.GetNParams(), false);
+  fFixedValues.resize(fLayout.GetNParams(), 0);
+}
+
+void
+BoundedBFGS::SetMaxIter(int n_){
+  fMaxIter = n_;
+}
+
+void
+BoundedBFGS::SetTolerance(double t_){
+  fTolerance = t_;
+}
+
+void
+BoundedBFGS::Fix(size_t index_, double value_){
+  fFixed.at(index_) = true;
+  fFixedValues.at(index_) = value_;
+}
+
+void
+BoundedBFGS::Release(size_t index_){
+  fFixed.at(index_) = false;
+}
+
+bool
+BoundedBFGS::GetConverged() const{
+  return fConverged;
+}
+
+int
+BoundedBFGS::GetIterations() const{
+  return fIterations;
+}
+
+void
+BoundedBFGS::Clamp(std::vector<double>& x_) const{
+  const std::vector<double>& minima = fLayout.GetMinima();
+  const std::vector<double>& maxima = fLayout.GetMaxima();
+  for(size_t i = 0; i < x_.size(); i++){
+    if(fFixed[i])
+      x_[i] = fFixedValues[i];
+    else
+      x_[i] = std::min(std::max(x_[i], minima[i]), maxima[i]);
+  }
+}
+
+bool
+BoundedBFGS::IsActive(size_t i_, const std::vector<double>& x_, 
+                      const std::vector<double>& grad_) const{
+  if(fFixed[i_])
+    return true;
+  if(x_[i_] <= fLayout.GetMinima()[i_] && grad_[i_] > 0)
+    return true;
+  if(x_[i_] >= fLayout.GetMaxima()[i_] && grad_[i_] < 0)
+    return true;
+  return false;
+}
+
+void
+BoundedBFGS::ResetInverseHessian(){
+  // the configured step sizes set the starting scale
+  size_t n = fLayout.GetNParams();
+  const std::vector<double>& sigmas = fLayout.GetSigmas();
+  fInvHess.assign(n * n, 0);
+  for(size_t i = 0; i < n; i++)
+    fInvHess[i * n + i] = sigmas[i] * sigmas[i];
+}
+
+double
+BoundedBFGS::Minimise(std::vector<double>& x_){
+  size_t n = fLayout.GetNParams();
+  if(x_.size() != n)
+    throw DimensionError("BoundedBFGS::Starting point has the wrong number of parameters");
+
+  const std::vector<double>& sigmas = fLayout.GetSigmas();
+  Clamp(x_);
+  ResetInverseHessian();
+  fConverged = false;
+
+  std::vector<double> grad(n);
+  std::vector<double> newGrad(n);
+  std::vector<double> dir(n);
+  std::vector<double> trial(n);
+  std::vector<double> s(n);
+  std::vector<double> y(n);
+  std::vector<bool>   active(n);
+
+  // nothing can be learned from an infinite start, the gradient there is
+  // meaningless. Try the middle of the box before giving up
+  double f = fLH.EvaluateGradient(&x_[0], &grad[0]);
+  if(!std::isfinite(f)){
+    for(size_t i = 0; i < n; i++)
+      x_[i] = 0.5 * (fLayout.GetMinima()[i] + fLayout.GetMaxima()[i]);
+    Clamp(x_);
+    f = fLH.EvaluateGradient(&x_[0], &grad[0]);
+  }
+  if(!std::isfinite(f))
+    throw ValueError(Formatter() << "BoundedBFGS::-log(lh) is " << f 
+                     << " at the start point and in the middle of the box");
+  bool steepest = true;
+
+  for(fIterations = 0; fIterations < fMaxIter; fIterations++){
+    // converged if the projected gradient is small on the parameter scale
+    double projGrad = 0;
+    for(size_t i = 0; i < n; i++){
+      active[i] = IsActive(i, x_, grad);
+      if(!active[i])
+        projGrad = std::max(projGrad, std::abs(grad[i]) * sigmas[i]);
+    }
+    if(projGrad < fTolerance){
+      fConverged = true;
+      break;
+    }
+
+    // quasi newton direction in the free subspace
+    double slope = 0;
+    for(size_t i = 0; i < n; i++){
+      dir[i] = 0;
+      if(active[i])
+        continue;
+      for(size_t j = 0; j < n; j++)
+        if(!active[j])
+          dir[i] -= fInvHess[i * n + j] * grad[j];
+      slope += dir[i] * grad[i];
+    }
+
+    // not downhill, or the last line search failed, fall back to scaled
+    // steepest descent
+    if(slope >= 0 || steepest){
+      ResetInverseHessian();
+      steepest = true;
+      slope = 0;
+      for(size_t i = 0; i < n; i++){
+        dir[i] = active[i] ? 0 : -sigmas[i] * sigmas[i] * grad[i];
+        slope += dir[i] * grad[i];
+      }
+    }
+
+    // projected backtracking line search, armijo condition on the actual step
+    double step = 1;
+    double newF = f;
+    bool   moved = false;
+    for(int iLine = 0; iLine < 60; iLine++, step *= 0.5){
+      for(size_t i = 0; i < n; i++)
+        trial[i] = x_[i] + step * dir[i];
+      Clamp(trial);
+
+      double decrease = 0;
+      for(size_t i = 0; i < n; i++)
+        decrease += grad[i] * (trial[i] - x_[i]);
+
+      // once the step is lost in rounding nothing moves, that isn't progress
+      if(!(decrease < 0))
+        break;
+      newF = fLH.EvaluateGradient(&trial[0], &newGrad[0]);
+      if(std::isfinite(newF) && newF <= f + 1e-4 * decrease){
+        moved = true;
+        break;
+      }
+    }
+    // a stale inverse hessian can point nowhere useful, retry the plain 
+    // gradient before giving up. Failing that the fit stalled, it didn't converge
+    if(!moved && !steepest){
+      steepest = true;
+      continue;
+    }
+    if(!moved)
+      break;
+    steepest = false;
+
+    double sy = 0;
+    double stepSize = 0;
+    for(size_t i = 0; i < n; i++){
+      s[i] = trial[i] - x_[i];
+      y[i] = newGrad[i] - grad[i];
+      sy += s[i] * y[i];
+      stepSize = std::max(stepSize, std::abs(s[i])/sigmas[i]);
+    }
+
+    double change = f - newF;
+    x_ = trial;
+    grad = newGrad;
+    f = newF;
+
+    // or if the step or the decrease it bought were negligible
+    if(stepSize < fTolerance || change < fTolerance * (std::abs(f) + fTolerance)){
+      fConverged = true;
+      break;
+    }
+
+    // BFGS update of the inverse hessian, skipped if it would lose positivity
+    if(sy <= 1e-12)
+      continue;
+    std::vector<double> hy(n, 0);
+    double yhy = 0;
+    for(size_t i = 0; i < n; i++){
+      for(size_t j = 0; j < n; j++)
+        hy[i] += fInvHess[i * n + j] * y[j];
+      yhy += y[i] * hy[i];
+    }
+    double rho = 1/sy;
+    for(size_t i = 0; i < n; i++)
+      for(size_t j = 0; j < n; j++)
+        fInvHess[i * n + j] += rho * ((1 + rho * yhy) * s[i] * s[j] 
+                                      - hy[i] * s[j] - s[i] * hy[j]);
+  }
+  return f;
+}
+
+}
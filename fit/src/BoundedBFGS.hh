@@ -0,0 +1,48 @@
+#ifndef __BBFIT__BoundedBFGS__
+#define __BBFIT__BoundedBFGS__
+#include <ParameterLayout.hh>
+#include <vector>
+
+// Quasi-Newton minimisation of an IndexedLikelihood inside the box from the
+// layout. BFGS inverse-hessian updates on the free parameters, with a
+// projected backtracking line search, parameters sitting on a bound with the 
+// gradient pushing them out are held there. Individual parameters can be
+// fixed, which is all a profile scan needs
+
+namespace bbfit{
+class IndexedLikelihood;
+class BoundedBFGS{
+public:
+  BoundedBFGS(const IndexedLikelihood& lh_, const ParameterLayout& layout_);
+
+  void SetMaxIter(int);
+  void SetTolerance(double);
+
+  void Fix(size_t index_, double value_);
+  void Release(size_t index_);
+
+  // starts from x_ (clamped into the box), or the middle of the box if -log(lh)
+  // isn't finite there, leaves the minimum in x_. Throws if neither is finite
+  double Minimise(std::vector<double>& x_);
+
+  bool   GetConverged() const;
+  int    GetIterations() const;
+
+private:
+  void Clamp(std::vector<double>& x_) const;
+  bool IsActive(size_t index_, const std::vector<double>& x_, 
+                const std::vector<double>& grad_) const;
+  void ResetInverseHessian();
+
+  const IndexedLikelihood& fLH;
+  ParameterLayout fLayout;
+  int    fMaxIter;
+  double fTolerance;
+  std::vector<bool>   fFixed;
+  std::vector<double> fFixedValues;
+  std::vector<double> fInvHess;
+  bool   fConverged;
+  int    fIterations;
+};
+}
+#endif
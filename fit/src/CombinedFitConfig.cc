@@ -0,0 +1,111 @@
+#include <CombinedFitConfig.hh>
+#include <Exceptions.h>
+#include <algorithm>
+
+namespace bbfit{
+
+size_t
+CombinedFitConfig::GetNDataSets() const{
+  return fNames.size();
+}
+
+void
+CombinedFitConfig::GetDataSet(size_t index_, std::string& name_, 
+                              std::string& fitConfig_, std::string& distConfig_, 
+                              std::string& cutConfig_, std::string& dataPath_) const{
+  try{
+    name_ = fNames.at(index_);
+    fitConfig_ = fFitConfigs.at(index_);
+    distConfig_ = fDistConfigs.at(index_);
+    cutConfig_ = fCutConfigs.at(index_);
+    dataPath_ = fDataPaths.at(index_);
+  }
+  catch(const std::out_of_range& e_){
+    throw NotFoundError(Formatter() << "CombinedFitConfig::No data set " << index_);
+  }
+}
+
+void
+CombinedFitConfig::AddDataSet(const std::string& name_, 
+                              const std::string& fitConfig_, const std::string& distConfig_, 
+                              const std::string& cutConfig_, const std::string& dataPath_){
+  if(std::find(fNames.begin(), fNames.end(), name_) != fNames.end())
+    throw ValueError("CombinedFitConfig::Data set " + name_ + " is in there twice");
+  fNames.push_back(name_);
+  fFitConfigs.push_back(fitConfig_);
+  fDistConfigs.push_back(distConfig_);
+  fCutConfigs.push_back(cutConfig_);
+  fDataPaths.push_back(dataPath_);
+}
+
+const std::set<std::string>&
+CombinedFitConfig::GetShared() const{
+  return fShared;
+}
+
+void
+CombinedFitConfig::SetShared(const std::set<std::string>& shared_){
+  fShared = shared_;
+}
+
+int
+CombinedFitConfig::GetNThreads() const{
+  return fNThreads;
+}
+
+void
+CombinedFitConfig::SetNThreads(int n_){
+  fNThreads = n_;
+}
+
+const std::string&
+CombinedFitConfig::GetOutDir() const{
+  return fOutDir;
+}
+
+void
+CombinedFitConfig::SetOutDir(const std::string& s_){
+  fOutDir = s_;
+}
+
+int
+CombinedFitConfig::GetIterations() const{
+  return fIterations;
+}
+
+void
+CombinedFitConfig::SetIterations(int i_){
+  fIterations = i_;
+}
+
+int
+CombinedFitConfig::GetBurnIn() const{
+  return fBurnIn;
+}
+
+void
+CombinedFitConfig::SetBurnIn(int i_){
+  fBurnIn = i_;
+}
+
+int
+CombinedFitConfig::GetNSteps() const{
+  return fNSteps;
+}
+
+void
+CombinedFitConfig::SetNSteps(int i_){
+  fNSteps = i_;
+}
+
+double
+CombinedFitConfig::GetEpsilon() const{
+  return fEpsilon;
+}
+
+void
+CombinedFitConfig::SetEpsilon(double e_){
+  fEpsilon = e_;
+}
+
+}
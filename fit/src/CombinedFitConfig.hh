@@ -0,0 +1,61 @@
+#ifndef __BBFIT__CombinedFitConfig__
+#define __BBFIT__CombinedFitConfig__
+#include <string>
+#include <vector>
+#include <set>
+
+// A joint fit of several data sets, each with the usual fit/dist/cut configs
+// and data. Parameters named in the shared set are one parameter across all 
+// data sets, the rest become <name>_<data set>
+namespace bbfit{
+class CombinedFitConfig{
+public:
+  CombinedFitConfig() : fNThreads(0), fIterations(0), fBurnIn(0), fNSteps(0), fEpsilon(0) {}
+
+  size_t GetNDataSets() const;
+  void GetDataSet(size_t index_, std::string& name_, 
+                  std::string& fitConfig_, std::string& distConfig_, 
+                  std::string& cutConfig_, std::string& dataPath_) const;
+  void AddDataSet(const std::string& name_, 
+                  const std::string& fitConfig_, const std::string& distConfig_, 
+                  const std::string& cutConfig_, const std::string& dataPath_);
+
+  const std::set<std::string>& GetShared() const;
+  void SetShared(const std::set<std::string>&);
+
+  // threads evaluating the data sets, 0 for one per core
+  int  GetNThreads() const;
+  void SetNThreads(int);
+
+  // the sampler settings, as in a FitConfig
+  const std::string& GetOutDir() const;
+  void SetOutDir(const std::string&);
+
+  int  GetIterations() const;
+  void SetIterations(int);
+
+  int  GetBurnIn() const;
+  void SetBurnIn(int);
+
+  int  GetNSteps() const;
+  void SetNSteps(int);
+
+  double GetEpsilon() const;
+  void   SetEpsilon(double);
+
+private:
+  std::vector<std::string> fNames;
+  std::vector<std::string> fFitConfigs;
+  std::vector<std::string> fDistConfigs;
+  std::vector<std::string> fCutConfigs;
+  std::vector<std::string> fDataPaths;
+  std::set<std::string> fShared;
+  int         fNThreads;
+  std::string fOutDir;
+  int         fIterations;
+  int         fBurnIn;
+  int         fNSteps;
+  double      fEpsilon;
+};
+}
+#endif
@@ -0,0 +1,75 @@
+#include <CombinedFitConfigLoader.hh>
+#include <ConfigLoader.hh>
+#include <Exceptions.h>
+#include <vector>
+
+namespace bbfit{
+
+CombinedFitConfigLoader::CombinedFitConfigLoader(const std::string& filePath_){
+  fPath = filePath_;
+}
+
+CombinedFitConfigLoader::~CombinedFitConfigLoader(){
+  ConfigLoader::Close();
+}
+
+CombinedFitConfig
+CombinedFitConfigLoader::Load() const{
+  ConfigLoader::Open(fPath);
+  CombinedFitConfig ret;
+
+  int it;
+  int burnIn;
+  int nSteps;
+  double epsilon;
+  std::string outDir;
+  ConfigLoader::Load("summary", "iterations", it);
+  ConfigLoader::Load("summary", "burn_in", burnIn);
+  ConfigLoader::Load("summary", "output_directory", outDir);
+  ConfigLoader::Load("summary", "n_steps", nSteps);
+  ConfigLoader::Load("summary", "epsilon", epsilon);
+  ret.SetIterations(it);
+  ret.SetBurnIn(burnIn);
+  ret.SetOutDir(outDir);
+  ret.SetNSteps(nSteps);
+  ret.SetEpsilon(epsilon);
+
+  // nothing shared is allowed, it's just separate fits then
+  std::set<std::string> shared;
+  try{
+    ConfigLoader::Load("summary", "shared", shared);
+  }
+  catch(const ConfigFieldMissing&){}
+  ret.SetShared(shared);
+
+  int nThreads = 0;
+  try{
+    ConfigLoader::Load("summary", "n_threads", nThreads);
+  }
+  catch(const ConfigFieldMissing&){}
+  if(nThreads < 0)
+    throw ValueError(Formatter() << "CombinedFitConfigLoader:: n_threads can't be negative, got " << nThreads);
+  ret.SetNThreads(nThreads);
+
+  std::vector<std::string> dataSets;
+  ConfigLoader::Load("summary", "datasets", dataSets);
+  std::set<std::string> sections = ConfigLoader::ListSections();
+
+  std::string fitConfig;
+  std::string distConfig;
+  std::string cutConfig;
+  std::string dataPath;
+  for(size_t i = 0; i < dataSets.size(); i++){
+    const std::string& name = dataSets.at(i);
+    if(!sections.count(name))
+      throw NotFoundError("CombinedFitConfigLoader:: " + name + " is in datasets but has no section!");
+    ConfigLoader::Load(name, "fit_config", fitConfig);
+    ConfigLoader::Load(name, "dist_config", distConfig);
+    ConfigLoader::Load(name, "cut_config", cutConfig);
+    ConfigLoader::Load(name, "data", dataPath);
+    ret.AddDataSet(name, fitConfig, distConfig, cutConfig, dataPath);
+  }
+  return ret;
+}
+
+}
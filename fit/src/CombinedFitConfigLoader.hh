@@ -0,0 +1,21 @@
+#ifndef __BBFIT__CombinedFitConfigLoader__
+#define __BBFIT__CombinedFitConfigLoader__
+#include <CombinedFitConfig.hh>
+#include <string>
+
+// [summary] datasets = a,b and shared = 0v,2v, optionally n_threads, plus the 
+// sampler settings of a fit config. Then a section per data set: fit_config, 
+// dist_config, cut_config and data
+namespace bbfit{
+class CombinedFitConfigLoader{
+public:
+  CombinedFitConfigLoader(const std::string& filePath_);
+  ~CombinedFitConfigLoader();
+
+  CombinedFitConfig Load() const;
+
+private:
+  std::string fPath;
+};
+}
+#endif
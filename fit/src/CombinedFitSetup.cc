@@ -0,0 +1,124 @@
+#include <CombinedFitSetup.hh>
+#include <CombinedFitConfigLoader.hh>
+#include <FitSetup.hh>
+#include <Exceptions.h>
+#include <iostream>
+
+namespace bbfit{
+
+CombinedFitSetup::CombinedFitSetup(const std::string& configFile_, const std::string& dims_){
+  {
+    CombinedFitConfigLoader loader(configFile_);
+    fConfig = loader.Load();
+  }
+
+  std::string name;
+  std::string fitConfig;
+  std::string distConfig;
+  std::string cutConfig;
+  std::string dataPath;
+  for(size_t d = 0; d < fConfig.GetNDataSets(); d++){
+    fConfig.GetDataSet(d, name, fitConfig, distConfig, cutConfig, dataPath);
+    std::cout << "Setting up data set " << name << " from " << dataPath << std::endl;
+    fNames.push_back(name);
+    fSetups.push_back(new FitSetup(fitConfig, distConfig, cutConfig, dataPath, dims_));
+    AddParameters(d);
+  }
+
+  // a typo here would quietly make two separate parameters
+  const std::set<std::string>& shared = fConfig.GetShared();
+  for(std::set<std::string>::const_iterator it = shared.begin(); it != shared.end(); ++it)
+    if(!fLayout.HasParameter(*it))
+      throw NotFoundError("CombinedFitSetup:: shared parameter " + *it + " isn't in any data set");
+}
+
+CombinedFitSetup::~CombinedFitSetup(){
+  for(size_t i = 0; i < fSetups.size(); i++)
+    delete fSetups[i];
+}
+
+void
+CombinedFitSetup::AddParameters(size_t dataSet_){
+  const ParameterLayout& layout = fSetups.at(dataSet_)->GetLayout();
+  const FitConfig& fitConfig = fSetups.at(dataSet_)->GetFitConfig();
+  const ParameterDict& constrMeans  = fitConfig.GetConstrMeans();
+  const ParameterDict& constrSigmas = fitConfig.GetConstrSigmas();
+
+  for(size_t k = 0; k < layout.GetNParams(); k++){
+    const std::string& param = layout.GetName(k);
+    std::string name = CombinedName(dataSet_, param);
+    if(!fLayout.HasParameter(name))
+      fLayout.AddParameter(name, layout.GetMinima().at(k), layout.GetMaxima().at(k),
+                           layout.GetSigmas().at(k), layout.GetNBins().at(k));
+    else{
+      size_t index = fLayout.GetIndex(name);
+      if(fLayout.GetMinima().at(index) != layout.GetMinima().at(k) || 
+         fLayout.GetMaxima().at(index) != layout.GetMaxima().at(k))
+        throw ValueError("CombinedFitSetup:: shared parameter " + name + " has a different range in "
+                         + fNames.at(dataSet_));
+    }
+
+    // a shared constraint is one measurement, it only counts once
+    ParameterDict::const_iterator mean = constrMeans.find(param);
+    if(mean == constrMeans.end())
+      continue;
+    double sigma = constrSigmas.at(param);
+    if(!fConstrMeans.count(name)){
+      fConstrMeans[name] = mean->second;
+      fConstrSigmas[name] = sigma;
+    }
+    else if(fConstrMeans[name] != mean->second || fConstrSigmas[name] != sigma)
+      throw ValueError("CombinedFitSetup:: shared parameter " + name + " has a different constraint in "
+                       + fNames.at(dataSet_));
+  }
+}
+
+const CombinedFitConfig&
+CombinedFitSetup::GetConfig() const{
+  return fConfig;
+}
+
+const ParameterLayout&
+CombinedFitSetup::GetLayout() const{
+  return fLayout;
+}
+
+size_t
+CombinedFitSetup::GetNDataSets() const{
+  return fSetups.size();
+}
+
+const std::string&
+CombinedFitSetup::GetDataSetName(size_t index_) const{
+  return fNames.at(index_);
+}
+
+const FitSetup&
+CombinedFitSetup::GetFitSetup(size_t index_) const{
+  return *fSetups.at(index_);
+}
+
+std::string
+CombinedFitSetup::CombinedName(size_t dataSet_, const std::string& param_) const{
+  if(fConfig.GetShared().count(param_))
+    return param_;
+  return param_ + "_" + fNames.at(dataSet_);
+}
+
+CombinedNLLH
+CombinedFitSetup::BuildLikelihood() const{
+  CombinedNLLH lh(fLayout, fConfig.GetNThreads());
+  for(size_t d = 0; d < fSetups.size(); d++){
+    const ParameterLayout& layout = fSetups[d]->GetLayout();
+    std::vector<size_t> paramMap;
+    for(size_t k = 0; k < layout.GetNParams(); k++)
+      paramMap.push_back(fLayout.GetIndex(CombinedName(d, layout.GetName(k))));
+    lh.AddDataSet(fNames[d], fSetups[d]->BuildLikelihood(false), paramMap);
+  }
+
+  for(ParameterDict::const_iterator it = fConstrMeans.begin(); it != fConstrMeans.end(); ++it)
+    lh.SetConstraint(it->first, it->second, fConstrSigmas.at(it->first));
+  return lh;
+}
+
+}
@@ -0,0 +1,48 @@
+#ifndef __BBFIT__CombinedFitSetup__
+#define __BBFIT__CombinedFitSetup__
+#include <CombinedFitConfig.hh>
+#include <CombinedNLLH.hh>
+#include <ParameterLayout.hh>
+#include <ParameterDict.h>
+#include <string>
+#include <vector>
+
+// A FitSetup for each data set of a combined fit, and the combined layout: 
+// the data sets' parameters in order, shared ones taken once from the first 
+// data set that has them
+
+namespace bbfit{
+class FitSetup;
+
+class CombinedFitSetup{
+public:
+  CombinedFitSetup(const std::string& configFile_, const std::string& dims_);
+  ~CombinedFitSetup();
+
+  const CombinedFitConfig& GetConfig() const;
+  const ParameterLayout& GetLayout() const;
+
+  size_t GetNDataSets() const;
+  const std::string& GetDataSetName(size_t index_) const;
+  const FitSetup& GetFitSetup(size_t index_) const;
+
+  // what a data set's parameter is called in the combined layout
+  std::string CombinedName(size_t dataSet_, const std::string& param_) const;
+
+  CombinedNLLH BuildLikelihood() const;
+
+private:
+  CombinedFitSetup(const CombinedFitSetup&);
+  CombinedFitSetup& operator=(const CombinedFitSetup&);
+
+  void AddParameters(size_t dataSet_);
+
+  CombinedFitConfig        fConfig;
+  std::vector<std::string> fNames;
+  std::vector<FitSetup*>   fSetups;
+  ParameterLayout          fLayout;
+  ParameterDict            fConstrMeans; // by combined name
+  ParameterDict            fConstrSigmas;
+};
+}
+#endif
@@ -0,0 +1,165 @@
+#include <CombinedNLLH.hh>
+#include <ThreadPool.hh>
+#include <Exceptions.h>
+#include <exception>
+#include <algorithm>
+#include <cmath>
+
+namespace bbfit{
+
+CombinedNLLH::CombinedNLLH(const ParameterLayout& layout_, size_t nThreads_) : fLayout(layout_), 
+                                                                            fNThreads(nThreads_){}
+
+void
+CombinedNLLH::AddDataSet(const std::string& name_, const IndexedBinnedNLLH& lh_, 
+                         const std::vector<size_t>& paramMap_){
+  if(paramMap_.size() != lh_.GetNParams())
+    throw DimensionError(Formatter() << "CombinedNLLH:: " << name_ << " has " << lh_.GetNParams()
+                         << " parameters but " << paramMap_.size() << " are mapped");
+  for(size_t k = 0; k < paramMap_.size(); k++)
+    if(paramMap_.at(k) >= fLayout.GetNParams())
+      throw NotFoundError(Formatter() << "CombinedNLLH:: " << name_ << " parameter " << k 
+                          << " maps to " << paramMap_.at(k) << ", there are only " 
+                          << fLayout.GetNParams());
+  fNames.push_back(name_);
+  fLikelihoods.push_back(lh_);
+  fParamMaps.push_back(paramMap_);
+
+  // setup time, so just start again with enough threads for them all
+  size_t nThreads = fNThreads ? fNThreads : std::thread::hardware_concurrency();
+  fPool.reset(new ThreadPool(std::min(nThreads, fLikelihoods.size())));
+}
+
+void
+CombinedNLLH::SetConstraint(const std::string& name_, double mean_, double sigma_){
+  fConstrParams.push_back(fLayout.GetIndex(name_));
+  fConstrMeans.push_back(mean_);
+  fConstrSigmas.push_back(sigma_);
+}
+
+size_t
+CombinedNLLH::GetNParams() const{
+  return fLayout.GetNParams();
+}
+
+size_t
+CombinedNLLH::GetNDataSets() const{
+  return fLikelihoods.size();
+}
+
+const std::string&
+CombinedNLLH::GetDataSetName(size_t index_) const{
+  return fNames.at(index_);
+}
+
+const IndexedBinnedNLLH&
+CombinedNLLH::GetDataSet(size_t index_) const{
+  return fLikelihoods.at(index_);
+}
+
+std::vector<double>
+CombinedNLLH::DataSetParams(size_t index_, const double* params_) const{
+  const std::vector<size_t>& map = fParamMaps.at(index_);
+  std::vector<double> local(map.size());
+  for(size_t k = 0; k < map.size(); k++)
+    local[k] = params_[map[k]];
+  return local;
+}
+
+double
+CombinedNLLH::ConstraintTerm(const double* params_, double* grad_) const{
+  double sum = 0;
+  for(size_t i = 0; i < fConstrParams.size(); i++){
+    double pull = (params_[fConstrParams[i]] - fConstrMeans[i])/fConstrSigmas[i];
+    sum += 0.5 * pull * pull;
+    if(grad_)
+      grad_[fConstrParams[i]] += pull/fConstrSigmas[i];
+  }
+  return sum;
+}
+
+// runs task_ for every data set on the pool, rethrowing the first thing that 
+// went wrong once they have all finished
+template<typename Task>
+static void
+RunAll(const std::shared_ptr<ThreadPool>& pool_, size_t nDataSets_, const Task& task_){
+  if(!pool_)
+    throw NotFoundError("CombinedNLLH:: no data sets to evaluate");
+  std::vector<std::exception_ptr> errors(nDataSets_);
+  pool_->Run(nDataSets_, [&](size_t d){
+      try{
+        task_(d);
+      }
+      catch(...){
+        errors[d] = std::current_exception();
+      }
+    });
+  for(size_t d = 0; d < nDataSets_; d++)
+    if(errors[d])
+      std::rethrow_exception(errors[d]);
+}
+
+double
+CombinedNLLH::Evaluate(const double* params_) const{
+  std::vector<double> nllhs(fLikelihoods.size());
+  RunAll(fPool, fLikelihoods.size(), [&](size_t d){
+      std::vector<double> local = DataSetParams(d, params_);
+      nllhs[d] = fLikelihoods[d].Evaluate(&local[0]);
+    });
+
+  double sum = 0;
+  for(size_t d = 0; d < nllhs.size(); d++)
+    sum += nllhs[d];
+  return sum + ConstraintTerm(params_, NULL);
+}
+
+double
+CombinedNLLH::EvaluateGradient(const double* params_, double* grad_) const{
+  std::vector<double> nllhs(fLikelihoods.size());
+  std::vector<std::vector<double> > grads(fLikelihoods.size());
+  RunAll(fPool, fLikelihoods.size(), [&](size_t d){
+      std::vector<double> local = DataSetParams(d, params_);
+      grads[d].resize(local.size());
+      nllhs[d] = fLikelihoods[d].EvaluateGradient(&local[0], &grads[d][0]);
+    });
+
+  for(size_t k = 0; k < GetNParams(); k++)
+    grad_[k] = 0;
+  double sum = 0;
+  for(size_t d = 0; d < nllhs.size(); d++){
+    sum += nllhs[d];
+    for(size_t k = 0; k < grads[d].size(); k++)
+      grad_[fParamMaps[d][k]] += grads[d][k];
+  }
+  if(std::isinf(sum))
+    return sum;
+  return sum + ConstraintTerm(params_, grad_);
+}
+
+void
+CombinedNLLH::GetBounds(std::vector<double>& minima_, std::vector<double>& maxima_) const{
+  minima_ = fLayout.GetMinima();
+  maxima_ = fLayout.GetMaxima();
+}
+
+void
+CombinedNLLH::EvaluateHessian(const double* params_, std::vector<double>& hess_) const{
+  std::vector<std::vector<double> > hessians(fLikelihoods.size());
+  RunAll(fPool, fLikelihoods.size(), [&](size_t d){
+      std::vector<double> local = DataSetParams(d, params_);
+      fLikelihoods[d].EvaluateHessian(&local[0], hessians[d]);
+    });
+
+  size_t nParams = GetNParams();
+  hess_.assign(nParams * nParams, 0);
+  for(size_t d = 0; d < hessians.size(); d++){
+    const std::vector<size_t>& map = fParamMaps[d];
+    for(size_t j = 0; j < map.size(); j++)
+      for(size_t k = 0; k < map.size(); k++)
+        hess_[map[j] * nParams + map[k]] += hessians[d][j * map.size() + k];
+  }
+  for(size_t i = 0; i < fConstrParams.size(); i++)
+    hess_[fConstrParams[i] * nParams + fConstrParams[i]] += 1/(fConstrSigmas[i] * fConstrSigmas[i]);
+}
+
+}
@@ -0,0 +1,62 @@
+#ifndef __BBFIT__CombinedNLLH__
+#define __BBFIT__CombinedNLLH__
+#include <IndexedLikelihood.hh>
+#include <IndexedBinnedNLLH.hh>
+#include <ParameterLayout.hh>
+#include <vector>
+#include <string>
+#include <memory>
+
+// Sum of independent binned -log(lh)s, one per data set, on a combined 
+// parameter layout. Each data set's likelihood keeps its own layout and a map 
+// from its parameters to the combined ones, so shared parameters are the same 
+// combined index in several data sets. The data sets are evaluated side by 
+// side on a ThreadPool, then summed in a fixed order so results don't depend 
+// on the threading. Constraints go on the combined parameters, the 
+// per data set likelihoods should have none
+
+namespace bbfit{
+class ThreadPool;
+
+class CombinedNLLH : public IndexedLikelihood{
+public:
+  // nThreads_ 0 for one per core, never more than there are data sets
+  CombinedNLLH(const ParameterLayout& layout_, size_t nThreads_ = 0);
+
+  // paramMap_[k] is the combined index of lh_'s parameter k
+  void AddDataSet(const std::string& name_, const IndexedBinnedNLLH& lh_, 
+                  const std::vector<size_t>& paramMap_);
+
+  void SetConstraint(const std::string& name_, double mean_, double sigma_);
+
+  size_t GetNParams() const;
+  size_t GetNDataSets() const;
+  const std::string& GetDataSetName(size_t index_) const;
+  const IndexedBinnedNLLH& GetDataSet(size_t index_) const;
+
+  // the data set's own parameters out of the combined ones
+  std::vector<double> DataSetParams(size_t index_, const double* params_) const;
+
+  double Evaluate(const double* params_) const;
+  double EvaluateGradient(const double* params_, double* grad_) const;
+  void   EvaluateHessian(const double* params_, std::vector<double>& hess_) const;
+  void   GetBounds(std::vector<double>& minima_, std::vector<double>& maxima_) const;
+
+private:
+  double ConstraintTerm(const double* params_, double* grad_) const;
+
+  ParameterLayout fLayout;
+  size_t          fNThreads;
+  std::vector<std::string>          fNames;
+  std::vector<IndexedBinnedNLLH>    fLikelihoods;
+  std::vector<std::vector<size_t> > fParamMaps;
+
+  // copies share it
+  std::shared_ptr<ThreadPool> fPool;
+
+  std::vector<size_t> fConstrParams;
+  std::vector<double> fConstrMeans;
+  std::vector<double> fConstrSigmas;
+};
+}
+#endif
@@ -0,0 +1,129 @@
+#include <CumulativeHistogram.hh>
+#include <BinnedED.h>
+#include <AxisCollection.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+
+namespace bbfit{
+
+CumulativeHistogram::CumulativeHistogram(const BinnedED& dist_) : fAxes(dist_.GetAxes()),
+                                                                  fObservables(dist_.GetObservables()){
+  const AxisCollection& axes = dist_.GetAxes();
+  size_t nDims = axes.GetNDimensions();
+  for(size_t d = 0; d < nDims; d++){
+    fNBins.push_back(axes.GetAxis(d).GetNBins());
+    std::vector<size_t> unit(nDims, 0);
+    unit[d] = 1;
+    fStrides.push_back(axes.FlattenIndices(unit));
+  }
+
+  // running sum along one axis at a time
+  fSums = dist_.GetBinContents();
+  for(size_t d = 0; d < nDims; d++){
+    size_t stride = fStrides[d];
+    for(size_t i = 0; i < fSums.size(); i++)
+      if((i / stride) % fNBins[d])
+        fSums[i] += fSums[i - stride];
+  }
+}
+
+double
+CumulativeHistogram::Sum(const std::vector<size_t>& lower_, const std::vector<size_t>& upper_) const{
+  size_t nDims = fNBins.size();
+  if(lower_.size() != nDims || upper_.size() != nDims)
+    throw DimensionError(Formatter() << "CumulativeHistogram::Sum expected " << nDims 
+                         << " dimensional box, got " << lower_.size() << " and " << upper_.size());
+
+  for(size_t d = 0; d < nDims; d++)
+    if(lower_[d] >= upper_[d] || upper_[d] > fNBins[d])
+      return 0;
+
+  // inclusion-exclusion over the corners: each axis takes either upper - 1 
+  // or lower - 1, the latter with a minus sign and nothing if lower is 0
+  double sum = 0;
+  for(size_t corner = 0; corner < (size_t(1) << nDims); corner++){
+    size_t index = 0;
+    int sign = 1;
+    bool empty = false;
+    for(size_t d = 0; d < nDims && !empty; d++){
+      if(corner & (size_t(1) << d)){
+        if(!lower_[d])
+          empty = true;
+        index += (lower_[d] - 1) * fStrides[d];
+        sign = -sign;
+      }
+      else
+        index += (upper_[d] - 1) * fStrides[d];
+    }
+    if(!empty)
+      sum += sign * fSums[index];
+  }
+  return sum;
+}
+
+BinnedED
+CumulativeHistogram::PdfAt(const std::vector<size_t>& cutDims_, const std::vector<size_t>& lower_, 
+                           const std::vector<size_t>& upper_, const std::string& name_, 
+                           bool normalise_) const{
+  size_t nDims = fNBins.size();
+  if(lower_.size() != cutDims_.size() || upper_.size() != cutDims_.size())
+    throw DimensionError(Formatter() << "CumulativeHistogram::PdfAt " << cutDims_.size() 
+                         << " cut axes, but " << lower_.size() << " lower and " 
+                         << upper_.size() << " upper limits");
+
+  // the whole range on every axis, narrowed on the cut ones
+  std::vector<size_t> lower(nDims, 0);
+  std::vector<size_t> upper(fNBins);
+  std::vector<bool>   cut(nDims, false);
+  for(size_t i = 0; i < cutDims_.size(); i++){
+    size_t d = cutDims_.at(i);
+    if(d >= nDims || cut[d])
+      throw DimensionError(Formatter() << "CumulativeHistogram::PdfAt can't cut on axis " << d);
+    cut[d] = true;
+    lower[d] = lower_[i];
+    upper[d] = upper_[i];
+  }
+
+  AxisCollection kept;
+  std::vector<std::string> keptObs;
+  std::vector<size_t> keptDims;
+  for(size_t d = 0; d < nDims; d++)
+    if(!cut[d]){
+      kept.AddAxis(fAxes.GetAxis(d));
+      keptObs.push_back(fObservables.at(d));
+      keptDims.push_back(d);
+    }
+  if(keptDims.empty())
+    throw DimensionError("CumulativeHistogram::PdfAt every axis is cut, nothing left for a pdf");
+
+  // each bin of the result is a box one bin wide on the kept axes
+  BinnedED pdf(name_, kept);
+  pdf.SetObservables(keptObs);
+  for(size_t bin = 0; bin < pdf.GetNBins(); bin++){
+    for(size_t k = 0; k < keptDims.size(); k++){
+      lower[keptDims[k]] = kept.UnflattenIndex(bin, k);
+      upper[keptDims[k]] = lower[keptDims[k]] + 1;
+    }
+    pdf.SetBinContent(bin, Sum(lower, upper));
+  }
+  if(normalise_ && pdf.Integral())
+    pdf.Normalise();
+  return pdf;
+}
+
+double
+CumulativeHistogram::Total() const{
+  return fSums.empty() ? 0 : fSums.back();
+}
+
+size_t
+CumulativeHistogram::GetNDims() const{
+  return fNBins.size();
+}
+
+size_t
+CumulativeHistogram::GetNBins(size_t dim_) const{
+  return fNBins.at(dim_);
+}
+
+}
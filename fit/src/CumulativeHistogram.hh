@@ -0,0 +1,40 @@
+// Summed-area table of a binned dist: the contents of any box of bins from
+// 2^ndims lookups, however big the box
+#ifndef __BBFIT__CumulativeHistogram__
+#define __BBFIT__CumulativeHistogram__
+#include <AxisCollection.h>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+class BinnedED;
+
+namespace bbfit{
+class CumulativeHistogram{
+public:
+  CumulativeHistogram() {}
+  CumulativeHistogram(const BinnedED& dist_);
+
+  // sum of the bins with lower_[d] <= index < upper_[d] on every axis d
+  double Sum(const std::vector<size_t>& lower_, const std::vector<size_t>& upper_) const;
+  double Total() const;
+
+  // the dist over the axes not in cutDims_ of the events with lower_[i] <= 
+  // index < upper_[i] on axis cutDims_[i], i.e. the pdf after those cuts. 
+  // 2^ndims lookups a bin of the result, however wide the cuts
+  BinnedED PdfAt(const std::vector<size_t>& cutDims_, const std::vector<size_t>& lower_, 
+                 const std::vector<size_t>& upper_, const std::string& name_, 
+                 bool normalise_ = true) const;
+
+  size_t GetNDims() const;
+  size_t GetNBins(size_t dim_) const;
+
+private:
+  std::vector<double> fSums;    // sum of all bins with every index <= this one's
+  std::vector<size_t> fNBins;
+  std::vector<size_t> fStrides;
+  AxisCollection      fAxes;
+  std::vector<std::string> fObservables;
+};
+}
+#endif
@@ -3,6 +3,7 @@
 #include <ConfigLoader.hh>
 #include <map>
 #include <algorithm>
+#include <Exceptions.h>
 
 namespace bbfit{
 
@@ -57,6 +58,34 @@ CutConfigLoader::LoadActive() const{
   return evVec;
 }
 
+bool
+CutConfigLoader::LoadUseCutIndex() const{
+  ConfigLoader::Open(fPath);
+  std::string useIndex;
+  try{
+    ConfigLoader::Load("summary", "cut_index", useIndex);
+  }
+  catch(const ConfigFieldMissing&){
+    return false;
+  }
+  return useIndex == "true";
+}
+
+bool
+CutConfigLoader::LoadAdaptiveOrder() const{
+  ConfigLoader::Open(fPath);
+  std::string order;
+  try{
+    ConfigLoader::Load("summary", "cut_order", order);
+  }
+  catch(const ConfigFieldMissing&){
+    return false;
+  }
+  if(order != "adaptive" && order != "configured")
+    throw ValueError("Unknown cut_order " + order + " options are adaptive and configured");
+  return order == "adaptive";
+}
+
 CutConfigLoader::~CutConfigLoader(){ 
   ConfigLoader::Close();
 }
@@ -13,6 +13,12 @@ public:
   CutConfig LoadOne(const std::string& name_) const;
   std::vector<CutConfig> LoadActive() const;
 
+  // summary:cut_index = true to keep cut results next to the data
+  bool LoadUseCutIndex() const;
+
+  // summary:cut_order = adaptive to let the cut program reorder the cuts for speed
+  bool LoadAdaptiveOrder() const;
+
 private:
   std::string fPath;
 };
@@ -2,6 +2,8 @@
 #include <BoolCut.h>
 #include <BoxCut.h>
 #include <LineCut.h>
+#include <CutCollection.h>
+#include <CutConfig.hh>
 #include <Exceptions.h>
 
 namespace bbfit{
@@ -34,4 +36,17 @@ CutFactory::New(const std::string& name_,
   return cut;
 }
 
+CutCollection
+CutFactory::BuildCollection(const std::vector<CutConfig>& confs_){
+  CutCollection cutCol;
+  for(size_t i = 0; i < confs_.size(); i++){
+    CutConfig conf = confs_.at(i);
+    Cut *cut = New(conf.GetName(), conf.GetType(), conf.GetObs(), 
+                   conf.GetValue(), conf.GetValue2());
+    cutCol.AddCut(*cut);
+    delete cut; // cut col takes its own copy
+  }
+  return cutCol;
+}
+
 }
@@ -1,15 +1,21 @@
 #ifndef __BBFIT__CUTFactory__
 #define __BBFIT__CUTFactory__
 #include <string>
+#include <vector>
 
 class Cut;
+class CutCollection;
 namespace bbfit{
+class CutConfig;
 class CutFactory{
 public:
   static Cut* New(const std::string& name, 
 		  const std::string& type_, const std::string& obs_, 
 		  double value, double value2 = 0); 
   // v2 only needed for box
+
+  // all of them, in order
+  static CutCollection BuildCollection(const std::vector<CutConfig>&);
 };
 }
 #endif
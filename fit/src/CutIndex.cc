@@ -0,0 +1,153 @@
+#include <CutIndex.hh>
+#include <DataSet.h>
+#include <Event.h>
+#include <CutProgram.hh>
+#include <CutLog.h>
+#include <Exceptions.h>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <sys/stat.h>
+
+namespace bbfit{
+
+CutIndex::CutIndex(const std::string& dataPath_, const std::vector<CutConfig>& cuts_){
+  fDataPath = dataPath_;
+  fHash = Hash(cuts_);
+  fNEntries = 0;
+  for(size_t i = 0; i < cuts_.size(); i++)
+    fCutNames.push_back(cuts_.at(i).GetName());
+  fCutCounts.resize(fCutNames.size(), 0);
+
+  // X.root -> X.<hash>.cutidx
+  std::string stem = DataSetView::IndexPath(fDataPath);
+  stem = stem.substr(0, stem.size() - 4);
+  fPath = stem + "." + fHash + ".cutidx";
+}
+
+std::string
+CutIndex::Hash(const std::vector<CutConfig>& cuts_){
+  // FNV-1a over everything that changes which events pass, in order
+  std::ostringstream ss;
+  ss << std::setprecision(17);
+  for(size_t i = 0; i < cuts_.size(); i++){
+    CutConfig conf = cuts_.at(i);
+    ss << conf.GetName() << "|" << conf.GetType() << "|" << conf.GetObs() << "|" << conf.GetValue();
+    // bool cuts don't have a second value
+    if(conf.GetType() != "bool" && conf.GetType() != "==")
+      ss << "|" << conf.GetValue2();
+    ss << ";";
+  }
+
+  std::string s = ss.str();
+  unsigned long long h = 14695981039346656037ULL;
+  for(size_t i = 0; i < s.size(); i++){
+    h ^= (unsigned char)s[i];
+    h *= 1099511628211ULL;
+  }
+
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << h;
+  return hex.str();
+}
+
+std::string
+CutIndex::DataIdentity() const{
+  // the index file if the data is a view, otherwise the ntuple itself
+  std::string path = DataSetView::IndexPath(fDataPath);
+  struct stat st = {0};
+  if(stat(path.c_str(), &st) == -1){
+    path = fDataPath;
+    if(stat(path.c_str(), &st) == -1)
+      return "";
+  }
+  std::ostringstream ss;
+  ss << path << "|" << st.st_size << "|" << st.st_mtime;
+  return ss.str();
+}
+
+bool
+CutIndex::Load(size_t nEntries_){
+  std::ifstream ifs(fPath.c_str());
+  if(!ifs)
+    return false;
+
+  // header lines are key<tab>value, the identity can have spaces in it
+  std::string line;
+  std::vector<std::string> header;
+  for(int i = 0; i < 3 && std::getline(ifs, line); i++)
+    header.push_back(line.substr(line.find('\t') + 1));
+  if(header.size() != 3)
+    return false;
+
+  size_t nEntries;
+  std::istringstream(header.at(2)) >> nEntries;
+  if(header.at(0) != fHash || header.at(1) != DataIdentity() || nEntries != nEntries_)
+    return false;
+
+  std::string key;
+  std::vector<int> counts(fCutNames.size(), 0);
+  for(size_t i = 0; i < counts.size(); i++)
+    ifs >> key >> counts[i];
+
+  EntryRanges passing;
+  size_t first;
+  size_t last;
+  while(ifs >> first >> last)
+    passing.push_back(std::make_pair(first, last));
+  if(!ifs.eof())
+    return false;
+
+  fCutCounts = counts;
+  fPassing = passing;
+  fNEntries = nEntries;
+  return true;
+}
+
+void
+CutIndex::Save() const{
+  std::ofstream ofs(fPath.c_str());
+  if(!ofs)
+    throw IOError("CutIndex::Save couldn't open " + fPath);
+
+  // cut names can have spaces, so the counts are just numbered in order
+  ofs << "cuts\t" << fHash << "\n"
+      << "data\t" << DataIdentity() << "\n"
+      << "entries\t" << fNEntries << "\n";
+  for(size_t i = 0; i < fCutNames.size(); i++)
+    ofs << "cut" << i << "\t" << fCutCounts.at(i) << "\n";
+  for(size_t i = 0; i < fPassing.size(); i++)
+    ofs << fPassing.at(i).first << "\t" << fPassing.at(i).second << "\n";
+  ofs.close();
+}
+
+void
+CutIndex::Build(const DataSet& data_, const CutProgram& cuts_){
+  fNEntries = data_.GetNEntries();
+  cuts_.Select(data_, fPassing, fCutCounts);
+}
+
+const EntryRanges&
+CutIndex::GetPassing() const{
+  return fPassing;
+}
+
+size_t
+CutIndex::GetNPassing() const{
+  size_t n = 0;
+  for(size_t i = 0; i < fPassing.size(); i++)
+    n += fPassing.at(i).second - fPassing.at(i).first;
+  return n;
+}
+
+void
+CutIndex::FillLog(CutLog& log_) const{
+  CutProgram::LogCounts(log_, fCutCounts, GetNPassing());
+}
+
+const std::string&
+CutIndex::GetPath() const{
+  return fPath;
+}
+
+}
@@ -0,0 +1,50 @@
+// Sidecar file remembering which entries of a data set survive a set of cuts,
+// and how many fell at each cut, so rebuilding a dist only touches the survivors.
+// Keyed on a hash of the cut configuration, checked against the data file it indexes
+#ifndef __BBFIT__CutIndex__
+#define __BBFIT__CutIndex__
+#include <DataSetView.hh>
+#include <CutConfig.hh>
+#include <string>
+#include <vector>
+
+class DataSet;
+class CutLog;
+
+namespace bbfit{
+class CutProgram;
+
+class CutIndex{
+public:
+  CutIndex(const std::string& dataPath_, const std::vector<CutConfig>& cuts_);
+
+  // true if there is a sidecar for these cuts that matches the data file and nEntries_
+  bool Load(size_t nEntries_);
+  void Save() const;
+
+  // evaluate the cuts on every event
+  void Build(const DataSet&, const CutProgram&);
+
+  const EntryRanges& GetPassing() const;
+  size_t GetNPassing() const;
+
+  // add the stored counts to log_, as if the events had been cut again
+  void FillLog(CutLog& log_) const;
+
+  const std::string& GetPath() const;
+
+  static std::string Hash(const std::vector<CutConfig>&);
+
+private:
+  std::string DataIdentity() const;
+
+  std::string fDataPath;
+  std::string fHash;
+  std::string fPath;
+  std::vector<std::string> fCutNames;
+  std::vector<int> fCutCounts; // failed at each cut, in order
+  size_t fNEntries;
+  EntryRanges fPassing;
+};
+}
+#endif
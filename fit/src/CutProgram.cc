@@ -0,0 +1,383 @@
+#include <CutProgram.hh>
+#include <DataSet.h>
+#include <Event.h>
+#include <BinnedED.h>
+#include <CutLog.h>
+#include <EventWeight.hh>
+#include <WeightedCutLog.hh>
+#include <BinLookup.hh>
+#include <Exceptions.h>
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+
+namespace bbfit{
+
+CutProgram::CutProgram(const std::vector<CutConfig>& confs_){
+  fAdaptive = false;
+  for(size_t i = 0; i < confs_.size(); i++){
+    CutConfig conf = confs_.at(i);
+    const std::string& type = conf.GetType();
+
+    // same meanings as CutFactory::New
+    Instruction ins;
+    ins.fValue = conf.GetValue();
+    ins.fValue2 = 0;
+    if(type == "bool" || type == "==")
+      ins.fOp = kEqual;
+    else if(type == "box"){
+      ins.fOp = kInside;
+      ins.fValue2 = conf.GetValue2();
+    }
+    else if(type == "line")
+      ins.fOp = conf.GetValue2() > 0 ? kAbove : kBelow;
+    else
+      throw ValueError("Unknown cut type: " + type);
+
+    std::vector<std::string>::iterator it = std::find(fColumns.begin(), fColumns.end(), conf.GetObs());
+    ins.fColumn = it - fColumns.begin();
+    if(it == fColumns.end())
+      fColumns.push_back(conf.GetObs());
+
+    fInstructions.push_back(ins);
+    fCutNames.push_back(conf.GetName());
+  }
+}
+
+void
+CutProgram::SetAdaptiveOrder(bool b_){
+  fAdaptive = b_;
+}
+
+bool
+CutProgram::GetAdaptiveOrder() const{
+  return fAdaptive;
+}
+
+size_t
+CutProgram::GetNCuts() const{
+  return fInstructions.size();
+}
+
+const std::vector<std::string>&
+CutProgram::GetCutNames() const{
+  return fCutNames;
+}
+
+const std::vector<std::string>&
+CutProgram::GetColumns() const{
+  return fColumns;
+}
+
+void
+CutProgram::Evaluate(const std::vector<std::vector<double> >& columns_, size_t n_,
+                     std::vector<unsigned char>& mask_, std::vector<int>& counts_) const{
+  counts_.resize(fInstructions.size(), 0);
+  unsigned char* mask = &mask_.at(0);
+
+  // no branches in the inner loops so the compiler can vectorise them
+  for(size_t c = 0; c < fInstructions.size(); c++){
+    const Instruction& ins = fInstructions[c];
+    const double* col = &columns_.at(ins.fColumn).at(0);
+    const double v1 = ins.fValue;
+    const double v2 = ins.fValue2;
+    int failed = 0;
+    switch(ins.fOp){
+    case kEqual:
+      for(size_t i = 0; i < n_; i++){
+        unsigned char pass = col[i] == v1;
+        failed += mask[i] & (pass ^ 1);
+        mask[i] &= pass;
+      }
+      break;
+    case kInside:
+      for(size_t i = 0; i < n_; i++){
+        unsigned char pass = (col[i] > v1) & (col[i] < v2);
+        failed += mask[i] & (pass ^ 1);
+        mask[i] &= pass;
+      }
+      break;
+    case kAbove:
+      for(size_t i = 0; i < n_; i++){
+        unsigned char pass = col[i] > v1;
+        failed += mask[i] & (pass ^ 1);
+        mask[i] &= pass;
+      }
+      break;
+    case kBelow:
+      for(size_t i = 0; i < n_; i++){
+        unsigned char pass = col[i] < v1;
+        failed += mask[i] & (pass ^ 1);
+        mask[i] &= pass;
+      }
+      break;
+    }
+    counts_[c] += failed;
+  }
+}
+
+bool
+CutProgram::Passes(const Instruction& ins_, double val_){
+  switch(ins_.fOp){
+  case kEqual:
+    return val_ == ins_.fValue;
+  case kInside:
+    return val_ > ins_.fValue && val_ < ins_.fValue2;
+  case kAbove:
+    return val_ > ins_.fValue;
+  case kBelow:
+    return val_ < ins_.fValue;
+  }
+  return false;
+}
+
+size_t
+CutProgram::FirstFailed(const std::vector<std::vector<double> >& columns_, size_t idx_) const{
+  for(size_t c = 0; c < fInstructions.size(); c++)
+    if(!Passes(fInstructions[c], columns_[fInstructions[c].fColumn][idx_]))
+      return c;
+  return fInstructions.size();
+}
+
+size_t
+CutProgram::Apply(const Instruction& ins_, const double* col_, const size_t* in_, size_t nIn_,
+                  size_t* pass_, size_t* fail_, size_t& nFail_){
+  // write every index to both lists, only advance the one it belongs in
+  size_t nPass = 0;
+  nFail_ = 0;
+  for(size_t i = 0; i < nIn_; i++){
+    size_t idx = in_[i];
+    size_t pass = Passes(ins_, col_[idx]);
+    pass_[nPass] = idx;
+    fail_[nFail_] = idx;
+    nPass += pass;
+    nFail_ += pass ^ 1;
+  }
+  return nPass;
+}
+
+std::vector<size_t>
+CutProgram::Calibrate(const std::vector<std::vector<double> >& columns_, size_t n_) const{
+  std::vector<size_t> all(n_);
+  std::vector<size_t> pass(n_ + 1);
+  std::vector<size_t> fail(n_ + 1);
+  for(size_t i = 0; i < n_; i++)
+    all[i] = i;
+
+  // expected cost of running a cut first is its cost per event, and it saves the
+  // rest for the fraction it removes, so run in increasing cost/rejection
+  std::vector<std::pair<double, size_t> > ranks;
+  for(size_t c = 0; c < fInstructions.size(); c++){
+    const Instruction& ins = fInstructions[c];
+    size_t nFail;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    Apply(ins, &columns_.at(ins.fColumn).at(0), n_ ? &all[0] : NULL, n_, &pass[0], &fail[0], nFail);
+    double cost = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    double rejection = n_ ? double(nFail)/n_ : 0;
+    ranks.push_back(std::make_pair(rejection > 0 ? cost/rejection : 1e300, c));
+  }
+  std::stable_sort(ranks.begin(), ranks.end());
+
+  std::vector<size_t> order;
+  for(size_t i = 0; i < ranks.size(); i++)
+    order.push_back(ranks.at(i).second);
+  return order;
+}
+
+void
+CutProgram::EvaluateOrdered(const std::vector<std::vector<double> >& columns_, size_t n_,
+                            const std::vector<size_t>& order_,
+                            std::vector<unsigned char>& mask_, std::vector<int>& counts_) const{
+  counts_.resize(fInstructions.size(), 0);
+
+  // where each cut runs
+  std::vector<size_t> position(order_.size());
+  for(size_t s = 0; s < order_.size(); s++)
+    position[order_.at(s)] = s;
+
+  std::vector<size_t> alive(n_ + 1);
+  std::vector<size_t> next(n_ + 1);
+  std::vector<size_t> rejected(n_ + 1);
+  size_t nAlive = 0;
+  for(size_t i = 0; i < n_; i++){
+    alive[nAlive] = i;
+    nAlive += mask_[i];
+  }
+
+  for(size_t s = 0; s < order_.size() && nAlive; s++){
+    size_t k = order_.at(s);
+    const Instruction& ins = fInstructions[k];
+    size_t nRejected;
+    nAlive = Apply(ins, &columns_.at(ins.fColumn).at(0), &alive[0], nAlive, 
+                   &next[0], &rejected[0], nRejected);
+    alive.swap(next);
+
+    // the log wants the first cut in the configured order each event fails. Those
+    // configured before k that have already run were passed, so only check the
+    // ones that haven't run yet
+    for(size_t r = 0; r < nRejected; r++){
+      size_t idx = rejected[r];
+      size_t first = k;
+      for(size_t j = 0; j < k; j++){
+        const Instruction& earlier = fInstructions[j];
+        if(position[j] > s && !Passes(earlier, columns_[earlier.fColumn][idx])){
+          first = j;
+          break;
+        }
+      }
+      counts_[first]++;
+    }
+  }
+
+  for(size_t i = 0; i < n_; i++)
+    mask_[i] = 0;
+  for(size_t i = 0; i < nAlive; i++)
+    mask_[alive[i]] = 1;
+}
+
+std::vector<size_t>
+CutProgram::Resolve(const DataSet& data_) const{
+  std::vector<std::string> obs = data_.GetObservableNames();
+  std::vector<size_t> indices;
+  for(size_t i = 0; i < fColumns.size(); i++){
+    std::vector<std::string>::iterator it = std::find(obs.begin(), obs.end(), fColumns.at(i));
+    if(it == obs.end())
+      throw NotFoundError("CutProgram:: data set has no observable " + fColumns.at(i) + " to cut on");
+    indices.push_back(it - obs.begin());
+  }
+  return indices;
+}
+
+size_t
+CutProgram::LoadBlock(const DataSet& data_, size_t first_, const std::vector<size_t>& dataIndices_,
+                      std::vector<std::vector<double> >& columns_, std::vector<Event>* events_) const{
+  size_t n = std::min(kBlockSize, size_t(data_.GetNEntries()) - first_);
+  if(events_)
+    events_->clear();
+  for(size_t i = 0; i < n; i++){
+    Event ev = data_.GetEntry(first_ + i);
+    const std::vector<double>& vals = ev.GetData();
+    for(size_t c = 0; c < dataIndices_.size(); c++)
+      columns_[c][i] = vals[dataIndices_[c]];
+    if(events_)
+      events_->push_back(ev);
+  }
+  return n;
+}
+
+void
+CutProgram::Run(const std::vector<std::vector<double> >& columns_, size_t n_, std::vector<size_t>& order_,
+                std::vector<unsigned char>& mask_, std::vector<int>& counts_) const{
+  if(!fAdaptive){
+    Evaluate(columns_, n_, mask_, counts_);
+    return;
+  }
+
+  // first block decides the order for the rest
+  if(order_.empty() && fInstructions.size()){
+    order_ = Calibrate(columns_, n_);
+    std::cout << "CutProgram:: running cuts in order ";
+    for(size_t i = 0; i < order_.size(); i++)
+      std::cout << (i ? ", " : "") << fCutNames.at(order_.at(i));
+    std::cout << std::endl;
+  }
+  EvaluateOrdered(columns_, n_, order_, mask_, counts_);
+}
+
+void
+CutProgram::Fill(BinnedED& dist_, const DataSet& data_, CutLog& log_) const{
+  std::vector<size_t> dataIndices = Resolve(data_);
+  BinLookup lookup(dist_.GetAxes());
+  std::vector<size_t> obsIndices = BinLookup::Resolve(dist_, data_);
+  std::vector<std::vector<double> > columns(fColumns.size(), std::vector<double>(kBlockSize));
+  std::vector<unsigned char> mask(kBlockSize);
+  std::vector<Event> events;
+  events.reserve(kBlockSize);
+  std::vector<int> counts(fInstructions.size(), 0);
+  std::vector<size_t> order;
+  size_t nPassing = 0;
+
+  for(size_t first = 0; first < data_.GetNEntries(); first += kBlockSize){
+    size_t n = LoadBlock(data_, first, dataIndices, columns, &events);
+    std::fill(mask.begin(), mask.end(), 1);
+    Run(columns, n, order, mask, counts);
+    for(size_t i = 0; i < n; i++)
+      if(mask[i]){
+        dist_.AddBinContent(lookup.FindBin(events[i].GetData(), obsIndices), 1);
+        nPassing++;
+      }
+  }
+  LogCounts(log_, counts, nPassing);
+}
+
+void
+CutProgram::FillWeighted(BinnedED& dist_, BinnedED& sumW2_, const DataSet& data_, const EventWeight& weight_,
+                         CutLog& log_, WeightedCutLog& weightedLog_) const{
+  std::vector<size_t> dataIndices = Resolve(data_);
+  std::vector<size_t> weightIndices = weight_.Resolve(data_);
+  BinLookup lookup(dist_.GetAxes());
+  std::vector<size_t> obsIndices = BinLookup::Resolve(dist_, data_);
+  std::vector<std::vector<double> > columns(fColumns.size(), std::vector<double>(kBlockSize));
+  std::vector<unsigned char> mask(kBlockSize);
+  std::vector<Event> events;
+  events.reserve(kBlockSize);
+  std::vector<int> counts(fInstructions.size(), 0);
+  std::vector<size_t> order;
+  size_t nPassing = 0;
+
+  for(size_t first = 0; first < data_.GetNEntries(); first += kBlockSize){
+    size_t n = LoadBlock(data_, first, dataIndices, columns, &events);
+    std::fill(mask.begin(), mask.end(), 1);
+    Run(columns, n, order, mask, counts);
+    for(size_t i = 0; i < n; i++){
+      double w = weight_.Evaluate(events[i].GetData(), weightIndices);
+      if(!mask[i]){
+        weightedLog_.LogCut(FirstFailed(columns, i), w);
+        continue;
+      }
+      size_t bin = lookup.FindBin(events[i].GetData(), obsIndices);
+      dist_.AddBinContent(bin, w);
+      sumW2_.AddBinContent(bin, w * w);
+      weightedLog_.LogPass(w);
+      nPassing++;
+    }
+  }
+  LogCounts(log_, counts, nPassing);
+}
+
+void
+CutProgram::Select(const DataSet& data_, EntryRanges& passing_, std::vector<int>& counts_) const{
+  std::vector<size_t> dataIndices = Resolve(data_);
+  std::vector<std::vector<double> > columns(fColumns.size(), std::vector<double>(kBlockSize));
+  std::vector<unsigned char> mask(kBlockSize);
+  std::vector<size_t> order;
+  counts_.assign(fInstructions.size(), 0);
+  passing_.clear();
+
+  for(size_t first = 0; first < data_.GetNEntries(); first += kBlockSize){
+    size_t n = LoadBlock(data_, first, dataIndices, columns, NULL);
+    std::fill(mask.begin(), mask.end(), 1);
+    Run(columns, n, order, mask, counts_);
+    for(size_t i = 0; i < n; i++){
+      if(!mask[i])
+        continue;
+      size_t entry = first + i;
+      if(!passing_.empty() && passing_.back().second == entry)
+        passing_.back().second++;
+      else
+        passing_.push_back(std::make_pair(entry, entry + 1));
+    }
+  }
+}
+
+void
+CutProgram::LogCounts(CutLog& log_, const std::vector<int>& counts_, size_t nPassing_){
+  for(size_t i = 0; i < counts_.size(); i++)
+    for(int j = 0; j < counts_.at(i); j++)
+      log_.LogCut(i);
+  for(size_t i = 0; i < nPassing_; i++)
+    log_.LogPass();
+}
+
+}
@@ -0,0 +1,93 @@
+// The cuts from the cut config compiled down to flat compare instructions,
+// run a block of events at a time over column arrays rather than one virtual
+// call per cut per event. Cut order and the counts for the CutLog are the same
+// as CutCollection's: each event is counted against the first cut it fails
+#ifndef __BBFIT__CutProgram__
+#define __BBFIT__CutProgram__
+#include <DataSetView.hh>
+#include <CutConfig.hh>
+#include <string>
+#include <vector>
+
+class DataSet;
+class BinnedED;
+class CutLog;
+
+namespace bbfit{
+class EventWeight;
+class WeightedCutLog;
+
+class CutProgram{
+public:
+  CutProgram() : fAdaptive(false) {}
+  CutProgram(const std::vector<CutConfig>&);
+
+  // measure each cut's pass rate and cost on the first block of events and run
+  // the cheap, selective ones first. Counts still come out in the configured order
+  void SetAdaptiveOrder(bool b_);
+  bool GetAdaptiveOrder() const;
+
+  size_t GetNCuts() const;
+  const std::vector<std::string>& GetCutNames() const;
+
+  // the observables the cuts read, columns_ below are in this order
+  const std::vector<std::string>& GetColumns() const;
+
+  // mask_ should come in as 1 for the events to consider, comes out 1 for those
+  // passing every cut. counts_[i] += events whose first failed cut is i
+  void Evaluate(const std::vector<std::vector<double> >& columns_, size_t n_,
+                std::vector<unsigned char>& mask_, std::vector<int>& counts_) const;
+
+  // the order to run the cuts in, from the time per event and pass fraction of each on this block
+  std::vector<size_t> Calibrate(const std::vector<std::vector<double> >& columns_, size_t n_) const;
+
+  // as Evaluate, but running the cuts in order_ over only the events still alive
+  void EvaluateOrdered(const std::vector<std::vector<double> >& columns_, size_t n_,
+                       const std::vector<size_t>& order_,
+                       std::vector<unsigned char>& mask_, std::vector<int>& counts_) const;
+
+  // fill dist_ with the events of data_ passing the cuts, logging the rest
+  void Fill(BinnedED& dist_, const DataSet& data_, CutLog& log_) const;
+
+  // as Fill, each event weighted by weight_. weightedLog_ gets the weights 
+  // failing each cut too, sumW2_ (binned like dist_) the squared weights
+  void FillWeighted(BinnedED& dist_, BinnedED& sumW2_, const DataSet& data_, const EventWeight& weight_,
+                    CutLog& log_, WeightedCutLog& weightedLog_) const;
+
+  // which entries of data_ pass, and how many fail at each cut
+  void Select(const DataSet& data_, EntryRanges& passing_, std::vector<int>& counts_) const;
+
+  // replay counts from Evaluate/Select into a CutLog
+  static void LogCounts(CutLog& log_, const std::vector<int>& counts_, size_t nPassing_);
+
+  static const size_t kBlockSize = 4096;
+
+private:
+  enum Op {kEqual, kInside, kAbove, kBelow};
+  struct Instruction{
+    Op     fOp;
+    size_t fColumn;
+    double fValue;
+    double fValue2;
+  };
+
+  std::vector<size_t> Resolve(const DataSet&) const;
+  static bool   Passes(const Instruction&, double val_);
+  // the first cut, in the configured order, that event idx_ of the block fails
+  size_t FirstFailed(const std::vector<std::vector<double> >& columns_, size_t idx_) const;
+  // split the events in in_ into those passing and failing, returns the number passing
+  static size_t Apply(const Instruction&, const double* col_, const size_t* in_, size_t nIn_,
+                      size_t* pass_, size_t* fail_, size_t& nFail_);
+  // Evaluate or EvaluateOrdered, calibrating the order on the first call
+  void Run(const std::vector<std::vector<double> >& columns_, size_t n_, std::vector<size_t>& order_,
+           std::vector<unsigned char>& mask_, std::vector<int>& counts_) const;
+  size_t LoadBlock(const DataSet&, size_t first_, const std::vector<size_t>& dataIndices_,
+                   std::vector<std::vector<double> >& columns_, std::vector<Event>* events_) const;
+
+  std::vector<Instruction> fInstructions;
+  std::vector<std::string> fCutNames;
+  std::vector<std::string> fColumns;
+  bool fAdaptive;
+};
+}
+#endif
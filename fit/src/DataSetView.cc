@@ -0,0 +1,164 @@
+#include <DataSetView.hh>
+#include <ROOTNtuple.h>
+#include <Event.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <sys/stat.h>
+
+namespace bbfit{
+
+DataSetView::DataSetView(DataSet* source_, const EntryRanges& ranges_,
+                         const std::string& sourcePath_, const std::string& treeName_){
+  fSource = source_;
+  fRanges = ranges_;
+  fSourcePath = sourcePath_;
+  fTreeName = treeName_;
+
+  fNEntries = 0;
+  for(size_t i = 0; i < fRanges.size(); i++){
+    if(fRanges.at(i).second < fRanges.at(i).first || fRanges.at(i).second > fSource->GetNEntries())
+      throw ValueError(Formatter() << "DataSetView:: range [" << fRanges.at(i).first << ", " 
+                       << fRanges.at(i).second << ") outside of source with " 
+                       << fSource->GetNEntries() << " entries");
+    fOffsets.push_back(fNEntries);
+    fNEntries += fRanges.at(i).second - fRanges.at(i).first;
+  }
+}
+
+DataSetView::~DataSetView(){
+  delete fSource;
+}
+
+size_t
+DataSetView::GetSourceEntry(size_t i_) const{
+  if(i_ >= fNEntries)
+    throw NotFoundError(Formatter() << "DataSetView:: entry " << i_ << " out of range (" 
+                        << fNEntries << " entries)");
+  // last range starting at or before i_
+  size_t r = std::upper_bound(fOffsets.begin(), fOffsets.end(), i_) - fOffsets.begin() - 1;
+  return fRanges[r].first + (i_ - fOffsets[r]);
+}
+
+Event
+DataSetView::GetEntry(size_t i_) const{
+  return fSource->GetEntry(GetSourceEntry(i_));
+}
+
+unsigned
+DataSetView::GetNEntries() const{
+  return fNEntries;
+}
+
+unsigned
+DataSetView::GetNObservables() const{
+  return fSource->GetNObservables();
+}
+
+std::vector<std::string>
+DataSetView::GetObservableNames() const{
+  return fSource->GetObservableNames();
+}
+
+DataSet*
+DataSetView::Clone() const{
+  return new DataSetView(fSource->Clone(), fRanges, fSourcePath, fTreeName);
+}
+
+const EntryRanges&
+DataSetView::GetRanges() const{
+  return fRanges;
+}
+
+const std::string&
+DataSetView::GetSourcePath() const{
+  return fSourcePath;
+}
+
+void
+DataSetView::Save(const std::string& indexPath_) const{
+  Save(indexPath_, fSourcePath, fRanges, fTreeName);
+}
+
+void
+DataSetView::Save(const std::string& indexPath_, const std::string& sourcePath_,
+                  const EntryRanges& ranges_, const std::string& treeName_){
+  std::ofstream ofs(indexPath_.c_str());
+  if(!ofs)
+    throw IOError("DataSetView::Save couldn't open " + indexPath_);
+
+  size_t nEntries = 0;
+  for(size_t i = 0; i < ranges_.size(); i++)
+    nEntries += ranges_.at(i).second - ranges_.at(i).first;
+
+  ofs << "source\t" << sourcePath_ << "\n"
+      << "tree\t" << treeName_ << "\n"
+      << "entries\t" << nEntries << "\n";
+  for(size_t i = 0; i < ranges_.size(); i++)
+    ofs << ranges_.at(i).first << "\t" << ranges_.at(i).second << "\n";
+  ofs.close();
+}
+
+DataSetView*
+DataSetView::Load(const std::string& indexPath_){
+  std::ifstream ifs(indexPath_.c_str());
+  if(!ifs)
+    throw IOError("DataSetView::Load couldn't open " + indexPath_);
+
+  std::string key;
+  std::string sourcePath;
+  std::string treeName;
+  size_t nEntries = 0;
+  ifs >> key >> sourcePath;
+  if(key != "source")
+    throw IOError("DataSetView::Load " + indexPath_ + " isn't an index file, expected 'source' got " + key);
+  ifs >> key >> treeName >> key >> nEntries;
+
+  EntryRanges ranges;
+  size_t first;
+  size_t last;
+  size_t nRead = 0;
+  while(ifs >> first >> last){
+    ranges.push_back(std::make_pair(first, last));
+    nRead += last - first;
+  }
+  if(nRead != nEntries)
+    throw IOError(Formatter() << "DataSetView::Load " << indexPath_ << " expected " 
+                  << nEntries << " entries, ranges cover " << nRead);
+
+  return new DataSetView(new ROOTNtuple(sourcePath, treeName), ranges, sourcePath, treeName);
+}
+
+std::string
+DataSetView::IndexPath(const std::string& dataPath_){
+  size_t dot = dataPath_.rfind('.');
+  size_t slash = dataPath_.rfind('/');
+  if(dot == std::string::npos || (slash != std::string::npos && dot < slash))
+    return dataPath_ + ".idx";
+  return dataPath_.substr(0, dot) + ".idx";
+}
+
+DataSet*
+DataSetView::Open(const std::string& dataPath_, const std::string& treeName_){
+  std::string indexPath = IndexPath(dataPath_);
+  struct stat st = {0};
+  if(stat(indexPath.c_str(), &st) == 0)
+    return Load(indexPath);
+  return new ROOTNtuple(dataPath_, treeName_);
+}
+
+EntryRanges
+DataSetView::ToRanges(const std::vector<size_t>& entries_){
+  EntryRanges ranges;
+  for(size_t i = 0; i < entries_.size(); i++){
+    if(!ranges.empty() && ranges.back().second == entries_.at(i))
+      ranges.back().second++;
+    else
+      ranges.push_back(std::make_pair(entries_.at(i), entries_.at(i) + 1));
+  }
+  return ranges;
+}
+
+}
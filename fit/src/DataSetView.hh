@@ -0,0 +1,58 @@
+// A subset of the entries of another data set, stored as entry ranges.
+// Splits are saved as small index files next to the data instead of copies of it
+#ifndef __BBFIT__DataSetView__
+#define __BBFIT__DataSetView__
+#include <DataSet.h>
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace bbfit{
+// half open [first, last) entry ranges in the source
+typedef std::vector<std::pair<size_t, size_t> > EntryRanges;
+
+class DataSetView : public DataSet{
+public:
+  // takes ownership of the source
+  DataSetView(DataSet* source_, const EntryRanges& ranges_, 
+              const std::string& sourcePath_ = "", const std::string& treeName_ = "pruned");
+  ~DataSetView();
+
+  Event    GetEntry(size_t) const;
+  unsigned GetNEntries() const;
+  unsigned GetNObservables() const;
+  std::vector<std::string> GetObservableNames() const;
+  DataSet* Clone() const;
+
+  size_t GetSourceEntry(size_t) const;
+  const EntryRanges& GetRanges() const;
+  const std::string& GetSourcePath() const;
+
+  // index files
+  void Save(const std::string& indexPath_) const;
+  static void Save(const std::string& indexPath_, const std::string& sourcePath_,
+                   const EntryRanges&, const std::string& treeName_ = "pruned");
+  static DataSetView* Load(const std::string& indexPath_);
+
+  // X.root -> X.idx
+  static std::string IndexPath(const std::string& dataPath_);
+
+  // the view if there is an index file for this path, otherwise the ntuple itself
+  static DataSet* Open(const std::string& dataPath_, const std::string& treeName_ = "pruned");
+
+  // sorted entry numbers -> ranges
+  static EntryRanges ToRanges(const std::vector<size_t>& entries_);
+
+private:
+  DataSetView(const DataSetView&);
+  DataSetView& operator=(const DataSetView&);
+
+  DataSet*    fSource;
+  EntryRanges fRanges;
+  std::vector<size_t> fOffsets; // number of view entries before each range
+  size_t      fNEntries;
+  std::string fSourcePath;
+  std::string fTreeName;
+};
+}
+#endif
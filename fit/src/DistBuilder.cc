@@ -3,6 +3,17 @@
 #include <BinnedED.h>
 #include <DistFiller.h>
 #include <DataSet.h>
+#include <DataSetView.hh>
+#include <CutIndex.hh>
+#include <CutProgram.hh>
+#include <CutCollection.h>
+#include <CutLog.h>
+#include <BinnedKDE.hh>
+#include <EventWeight.hh>
+#include <WeightedCutLog.hh>
+#include <BinLookup.hh>
+#include <Exceptions.h>
+#include <iostream>
 
 
 namespace bbfit{
@@ -22,7 +33,14 @@ DistBuilder::BuildAxes(const DistConfig& config_){
   // save this last one for later
   for(int i = 0; i < config_.GetAxisCount(); i++){
     config_.GetAxis(i, name, branchName, texName, nBins, min, max);
-    axes.AddAxis(BinAxis(name, min, max, nBins, texName));
+    const std::vector<double>& edges = config_.GetBinEdges(i);
+    if(edges.empty()){
+      axes.AddAxis(BinAxis(name, min, max, nBins, texName));
+      continue;
+    }
+    std::vector<double> lowEdges(edges.begin(), edges.end() - 1);
+    std::vector<double> highEdges(edges.begin() + 1, edges.end());
+    axes.AddAxis(BinAxis(name, lowEdges, highEdges, texName));
   }
   
   return axes;
@@ -43,5 +61,133 @@ DistBuilder::Build(const std::string& name_, const DistConfig& pdfConfig_, DataS
   return dist;
 }
 
+BinnedED
+DistBuilder::Build(const std::string& name_, const DistConfig& pdfConfig_, const std::string& dataPath_,
+                   const std::vector<CutConfig>& cuts_, CutLog& log_, bool useCutIndex_,
+                   bool adaptiveOrder_){
+  CutProgram cuts(cuts_);
+  cuts.SetAdaptiveOrder(adaptiveOrder_);
+  DataSet* data = DataSetView::Open(dataPath_, "pruned");
+  if(!useCutIndex_){
+    BinnedED dist(name_, BuildAxes(pdfConfig_));
+    dist.SetObservables(pdfConfig_.GetBranchNames());
+    cuts.Fill(dist, *data, log_);
+    delete data;
+    return dist;
+  }
+
+  CutIndex index(dataPath_, cuts_);
+  if(index.Load(data->GetNEntries()))
+    std::cout << "Using cut index " << index.GetPath() << std::endl;
+  else{
+    std::cout << "Writing cut index " << index.GetPath() << std::endl;
+    index.Build(*data, cuts);
+    index.Save();
+  }
+  index.FillLog(log_);
+
+  // the survivors pass by construction, an empty program just bins them
+  DataSetView passing(data, index.GetPassing());
+  std::vector<std::string> noCuts;
+  CutLog scratch(noCuts);
+  BinnedED dist(name_, BuildAxes(pdfConfig_));
+  dist.SetObservables(pdfConfig_.GetBranchNames());
+  CutProgram().Fill(dist, passing, scratch);
+  return dist;
 }
 
+BinnedED
+DistBuilder::BuildWeighted(const std::string& name_, const DistConfig& pdfConfig_, const std::string& dataPath_,
+                           const std::vector<CutConfig>& cuts_, CutLog& log_, 
+                           WeightedCutLog& weightedLog_, BinnedED& sumW2_, bool useCutIndex_,
+                           bool adaptiveOrder_){
+  EventWeight weight(pdfConfig_.GetWeight());
+  CutProgram cuts(cuts_);
+  cuts.SetAdaptiveOrder(adaptiveOrder_);
+  DataSet* data = DataSetView::Open(dataPath_, "pruned");
+
+  BinnedED dist(name_, BuildAxes(pdfConfig_));
+  dist.SetObservables(pdfConfig_.GetBranchNames());
+  sumW2_ = BinnedED(name_ + "_sumw2", BuildAxes(pdfConfig_));
+  sumW2_.SetObservables(pdfConfig_.GetBranchNames());
+
+  if(!useCutIndex_){
+    cuts.FillWeighted(dist, sumW2_, *data, weight, log_, weightedLog_);
+    delete data;
+    return dist;
+  }
+
+  CutIndex index(dataPath_, cuts_);
+  if(index.Load(data->GetNEntries()))
+    std::cout << "Using cut index " << index.GetPath() << std::endl;
+  else{
+    std::cout << "Writing cut index " << index.GetPath() << std::endl;
+    index.Build(*data, cuts);
+    index.Save();
+  }
+  index.FillLog(log_);
+
+  // a reweighting is one pass over the survivors, the index kept no weights 
+  // for the events that were cut
+  DataSetView passing(data, index.GetPassing());
+  std::vector<size_t> weightIndices = weight.Resolve(passing);
+  BinLookup lookup(dist.GetAxes());
+  std::vector<size_t> obsIndices = BinLookup::Resolve(dist, passing);
+  for(size_t i = 0; i < passing.GetNEntries(); i++){
+    Event ev = passing.GetEntry(i);
+    double w = weight.Evaluate(ev.GetData(), weightIndices);
+    size_t bin = lookup.FindBin(ev.GetData(), obsIndices);
+    dist.AddBinContent(bin, w);
+    sumW2_.AddBinContent(bin, w * w);
+    weightedLog_.LogPass(w);
+  }
+  weightedLog_.SetCutCounts(log_.GetCutCounts());
+  return dist;
+}
+
+BinnedED
+DistBuilder::BuildKDE(const std::string& name_, const DistConfig& pdfConfig_, const std::string& dataPath_,
+                      const std::vector<CutConfig>& cuts_, CutLog& log_, BinnedED& counts_,
+                      bool useCutIndex_, bool adaptiveOrder_){
+  DistConfig fineConfig;
+  std::vector<int> oversamples;
+  std::vector<double> bandwidths;
+
+  double min;
+  double max;
+  int    nBins;
+  double bandwidth;
+  int    oversample;
+  std::string name;
+  std::string texName;
+  std::string branchName;
+  for(int i = 0; i < pdfConfig_.GetAxisCount(); i++){
+    pdfConfig_.GetAxis(i, name, branchName, texName, nBins, min, max);
+    if(!pdfConfig_.GetBinEdges(i).empty())
+      throw ValueError("DistBuilder::BuildKDE the kde needs uniform bins, " + name + " has bin_edges");
+    pdfConfig_.GetKDEAxis(i, bandwidth, oversample);
+    fineConfig.AddAxis(name, branchName, texName, nBins * oversample, min, max);
+    bandwidths.push_back(bandwidth);
+    oversamples.push_back(oversample);
+  }
+
+  BinnedED fine = Build(name_, fineConfig, dataPath_, cuts_, log_, useCutIndex_, adaptiveOrder_);
+  AxisCollection axes = BuildAxes(pdfConfig_);
+
+  // the fine bins nest inside the coarse ones, so the raw counts are just sums
+  counts_ = BinnedED(name_, axes);
+  counts_.SetObservables(pdfConfig_.GetBranchNames());
+  const AxisCollection& fineAxes = fine.GetAxes();
+  std::vector<size_t> indices(oversamples.size());
+  for(size_t bin = 0; bin < fine.GetNBins(); bin++){
+    double content = fine.GetBinContent(bin);
+    if(!content)
+      continue;
+    for(size_t d = 0; d < indices.size(); d++)
+      indices[d] = fineAxes.UnflattenIndex(bin, d) / oversamples[d];
+    counts_.AddBinContent(axes.FlattenIndices(indices), content);
+  }
+  return BinnedKDE::Estimate(fine, axes, bandwidths);
+}
+
+}
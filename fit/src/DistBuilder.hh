@@ -1,6 +1,7 @@
 #ifndef __BBFIT__DistBuilder__
 #define __BBFIT__DistBuilder__
 #include <string>
+#include <vector>
 
 class BinnedED;
 class DataSet;
@@ -11,11 +12,32 @@ class CutLog;
 namespace bbfit{
 class DistConfig;
 class EventConfig;
+class CutConfig;
+class WeightedCutLog;
 
 class DistBuilder{
 public:
     static BinnedED Build(const std::string& name, const DistConfig&, DataSet* data_, 
                           const CutCollection& cuts_, CutLog& log_);
+  // opens the data itself; with useCutIndex_ the cut results are kept in a
+  // sidecar next to the data and only the surviving events are read next time.
+  // adaptiveOrder_ lets the cut program pick the order the cuts run in
+  static BinnedED Build(const std::string& name, const DistConfig&, const std::string& dataPath_,
+                        const std::vector<CutConfig>& cuts_, CutLog& log_, bool useCutIndex_,
+                        bool adaptiveOrder_ = false);
+  // events weighted by the dist config's weight expression. weightedLog_ gets 
+  // the weighted cut counts, sumW2_ is binned like the result with the sum of 
+  // squared weights, for the MC statistical uncertainty
+  static BinnedED BuildWeighted(const std::string& name, const DistConfig&, const std::string& dataPath_,
+                                const std::vector<CutConfig>& cuts_, CutLog& log_, 
+                                WeightedCutLog& weightedLog_, BinnedED& sumW2_, bool useCutIndex_,
+                                bool adaptiveOrder_ = false);
+
+  // same, but filled oversampled and smoothed with BinnedKDE back onto the
+  // configured binning. counts_ gets the unsmoothed fill on that binning
+  static BinnedED BuildKDE(const std::string& name, const DistConfig&, const std::string& dataPath_,
+                           const std::vector<CutConfig>& cuts_, CutLog& log_, BinnedED& counts_,
+                           bool useCutIndex_, bool adaptiveOrder_ = false);
   static AxisCollection BuildAxes(const DistConfig&);
 
 };
@@ -36,6 +36,34 @@ DistConfig::AddAxis(const std::string& name_, const std::string& branchName_,
   fBinCounts.push_back(binCount_);
   fMinima.push_back(min_);
   fMaxima.push_back(max_);  
+  fBinEdges.push_back(std::vector<double>());
+  fKDEBandwidths.push_back(0.5 * (max_ - min_) / binCount_);
+  fKDEOversample.push_back(4);
+}
+
+void
+DistConfig::AddAxis(const std::string& name_, const std::string& branchName_, 
+		   const std::string& texName_,
+		   const std::vector<double>& binEdges_){
+  if(binEdges_.size() < 2)
+    throw ValueError(Formatter() << "DistConfig::" << name_ << " needs at least 2 bin edges, got " << binEdges_.size());
+  for(size_t i = 1; i < binEdges_.size(); i++)
+    if(!(binEdges_.at(i) > binEdges_.at(i - 1)))
+      throw ValueError(Formatter() << "DistConfig::" << name_ << " bin edges must be increasing, "
+                       << binEdges_.at(i) << " follows " << binEdges_.at(i - 1));
+
+  AddAxis(name_, branchName_, texName_, binEdges_.size() - 1, binEdges_.front(), binEdges_.back());
+  fBinEdges.back() = binEdges_;
+}
+
+const std::vector<double>&
+DistConfig::GetBinEdges(int index_) const{
+  try{
+    return fBinEdges.at(index_);
+  }
+  catch(const std::out_of_range& e_){
+    throw NotFoundError(Formatter() << "DistConfig::No data for axis " << index_);
+  }
 }
 
 const std::string&
@@ -48,6 +76,80 @@ DistConfig::SetPDFDir(const std::string& s_){
   fPDFDir = s_;
 }
 
+bool
+DistConfig::GetBundle() const{
+  return fBundle;
+}
+
+void
+DistConfig::SetBundle(bool b_){
+  fBundle = b_;
+}
+
+bool
+DistConfig::GetOutputContainer() const{
+  return fOutputContainer;
+}
+
+void
+DistConfig::SetOutputContainer(bool b_){
+  fOutputContainer = b_;
+}
+
+bool
+DistConfig::GetFactorised() const{
+  return fFactorised;
+}
+
+void
+DistConfig::SetFactorised(bool b_){
+  fFactorised = b_;
+}
+
+bool
+DistConfig::GetKDE() const{
+  return fKDE;
+}
+
+void
+DistConfig::SetKDE(bool b_){
+  fKDE = b_;
+}
+
+void
+DistConfig::GetKDEAxis(int index_, double& bandwidth_, int& oversample_) const{
+  try{
+    bandwidth_ = fKDEBandwidths.at(index_);
+    oversample_ = fKDEOversample.at(index_);
+  }
+  catch(const std::out_of_range& e_){
+    throw NotFoundError(Formatter() << "DistConfig::No kde settings for axis " << index_);
+  }
+}
+
+void
+DistConfig::SetKDEAxis(int index_, double bandwidth_, int oversample_){
+  if(oversample_ < 1)
+    throw ValueError(Formatter() << "DistConfig::kde oversample must be at least 1, got " << oversample_);
+  try{
+    fKDEBandwidths.at(index_) = bandwidth_;
+    fKDEOversample.at(index_) = oversample_;
+  }
+  catch(const std::out_of_range& e_){
+    throw NotFoundError(Formatter() << "DistConfig::No data for axis " << index_);
+  }
+}
+
+const std::string&
+DistConfig::GetWeight() const{
+  return fWeight;
+}
+
+void
+DistConfig::SetWeight(const std::string& s_){
+  fWeight = s_;
+}
+
 const std::vector<std::string>&
 DistConfig::GetBranchNames() const {
   return fBranchNames;
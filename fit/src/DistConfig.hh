@@ -6,6 +6,8 @@
 namespace bbfit{
 class DistConfig{
 public:
+  DistConfig() : fBundle(false), fOutputContainer(false), fFactorised(false), fKDE(false) {}
+
   int GetAxisCount() const;
   void GetAxis(int index_, 
                std::string& name_, std::string& branchName_, std::string& texName_,
@@ -13,20 +15,60 @@ public:
   void AddAxis(const std::string& name_, const std::string& branchName_, 
                const std::string& texName_,
                int binCount_, double min_, double max_);
+  // variable width axis, n_bins/min/max follow from the edges
+  void AddAxis(const std::string& name_, const std::string& branchName_, 
+               const std::string& texName_,
+               const std::vector<double>& binEdges_);
+
+  // empty for a uniform axis
+  const std::vector<double>& GetBinEdges(int index_) const;
 
   const std::string& GetPDFDir() const;
   void SetPDFDir(const std::string&);
 
+  // pdfs also written to / read from a single bundle file in the pdf dir
+  bool GetBundle() const;
+  void SetBundle(bool);
+
+  // projections/slices go in one root file per directory, not a file each
+  bool GetOutputContainer() const;
+  void SetOutputContainer(bool);
+
+  // the fit loads <name>.marginal.h5/<name>.conditional.h5 factor pairs, not dense pdfs
+  bool GetFactorised() const;
+  void SetFactorised(bool);
+
+  // pdfs are gaussian KDEs filled on a finer grid rather than plain histograms
+  bool GetKDE() const;
+  void SetKDE(bool);
+
+  // bandwidth in axis units, oversample is fine bins per bin. AddAxis sets
+  // half a bin and 4
+  void GetKDEAxis(int index_, double& bandwidth_, int& oversample_) const;
+  void SetKDEAxis(int index_, double bandwidth_, int oversample_);
+
+  // EventWeight expression the mc is weighted by, empty for unit weights
+  const std::string& GetWeight() const;
+  void SetWeight(const std::string&);
+
   const std::vector<std::string>& GetBranchNames() const;  
 
 private:
   std::string fPDFDir;
+  std::string fWeight;
+  bool fBundle;
+  bool fOutputContainer;
+  bool fFactorised;
+  bool fKDE;
   std::vector<std::string> fAxisNames;
   std::vector<std::string> fBranchNames;
   std::vector<std::string> fTexNames;
   std::vector<int> fBinCounts;
   std::vector<double> fMinima;
   std::vector<double> fMaxima;
+  std::vector<std::vector<double> > fBinEdges;
+  std::vector<double> fKDEBandwidths;
+  std::vector<int> fKDEOversample;
 };
 }
 #endif
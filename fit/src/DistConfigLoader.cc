@@ -7,6 +7,29 @@
 
 namespace bbfit{
 
+// optional true/false in [summary], false if it's not there
+static bool
+LoadSummaryFlag(const std::string& key_){
+  std::string val;
+  try{
+    ConfigLoader::Load("summary", key_, val);
+  }
+  catch(const ConfigFieldMissing&){
+    return false;
+  }
+  return val == "true";
+}
+
+// optional setting, keeps the default if it's not there
+template<typename T>
+static void
+LoadOptional(const std::string& section_, const std::string& key_, T& val_){
+  try{
+    ConfigLoader::Load(section_, key_, val_);
+  }
+  catch(const ConfigFieldMissing&){}
+}
+
 DistConfigLoader::DistConfigLoader(const std::string& filePath_){
     fPath = filePath_;    
 }
@@ -32,22 +55,46 @@ DistConfigLoader::Load() const{
   std::string branchName;
   std::string texName;
   int binCount;
+  double bandwidth;
+  int oversample;
+  std::vector<double> binEdges;
   for(size_t i = 0; i < order.size(); i++){
     if(std::find(toLoad.begin(), toLoad.end(), order.at(i)) == toLoad.end())
       throw NotFoundError(Formatter() << "DistConfigLoader:: " << order.at(i)
 			  << " is in the build order but has no section!");
     
     name = order.at(i);
-    ConfigLoader::Load(name, "min", min);
-    ConfigLoader::Load(name, "max", max);
-    ConfigLoader::Load(name, "n_bins", binCount);
     ConfigLoader::Load(name, "branch_name", branchName);
     ConfigLoader::Load(name, "tex_name", texName);
 
-    
-    retVal.AddAxis(name, branchName, texName, binCount, min, max);
+    // bin_edges replaces min/max/n_bins when it's there
+    binEdges.clear();
+    LoadOptional(name, "bin_edges", binEdges);
+    if(binEdges.empty()){
+      ConfigLoader::Load(name, "min", min);
+      ConfigLoader::Load(name, "max", max);
+      ConfigLoader::Load(name, "n_bins", binCount);
+      retVal.AddAxis(name, branchName, texName, binCount, min, max);
+    }
+    else
+      retVal.AddAxis(name, branchName, texName, binEdges);
+
+    retVal.GetKDEAxis(i, bandwidth, oversample);
+    LoadOptional(name, "kde_bandwidth", bandwidth);
+    LoadOptional(name, "kde_oversample", oversample);
+    retVal.SetKDEAxis(i, bandwidth, oversample);
   }
   retVal.SetPDFDir(pdfDir);
+  retVal.SetBundle(LoadSummaryFlag("bundle"));
+  retVal.SetOutputContainer(LoadSummaryFlag("output_container"));
+  retVal.SetFactorised(LoadSummaryFlag("factorised"));
+  retVal.SetKDE(LoadSummaryFlag("kde"));
+
+  std::string weight;
+  LoadOptional("summary", "weight", weight);
+  retVal.SetWeight(weight);
+  if(retVal.GetKDE() && !weight.empty())
+    throw ValueError("DistConfigLoader:: weighted events can't go through the kde yet");
   return retVal;
 }
 
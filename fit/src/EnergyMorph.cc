@@ -0,0 +1,171 @@
+#include <EnergyMorph.hh>
+#include <AxisCollection.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace bbfit{
+
+// morphed matrices kept, enough for a gradient's worth of shifted nuisances
+static const size_t kMaxRecent = 4;
+
+EnergyMorph::EnergyMorph(const AxisCollection& axes_, const std::string& axis_) : fAxisName(axis_), fScale(1), fResolution(0){
+  std::vector<std::string> names = axes_.GetAxisNames();
+  size_t d = std::find(names.begin(), names.end(), axis_) - names.begin();
+  if(d == names.size())
+    throw NotFoundError("EnergyMorph:: pdfs have no axis " + axis_ + " to morph");
+
+  const BinAxis& axis = axes_.GetAxis(d);
+  fNE = axis.GetNBins();
+  for(size_t e = 0; e < fNE; e++){
+    fLowEdges.push_back(axis.GetBinLowEdge(e));
+    fHighEdges.push_back(axis.GetBinHighEdge(e));
+  }
+  std::vector<size_t> unit(names.size(), 0);
+  unit[d] = 1;
+  fStride = axes_.FlattenIndices(unit);
+  fNBins  = axes_.GetNBins();
+
+  // nominal is the identity
+  ScaleOperator(fScale, fScaleOp);
+  ResolutionOperator(fResolution, fResolutionOp);
+  UpdateOperator(fScale, fResolution);
+}
+
+const std::string&
+EnergyMorph::GetAxisName() const{
+  return fAxisName;
+}
+
+void
+EnergyMorph::ScaleOperator(double scale_, std::vector<double>& op_) const{
+  if(scale_ <= 0)
+    throw ValueError(Formatter() << "EnergyMorph:: energy scale must be positive, got " << scale_);
+
+  // bin k is spread evenly over [scale lo_k, scale hi_k]
+  op_.assign(fNE * fNE, 0);
+  for(size_t k = 0; k < fNE; k++){
+    double lo = scale_ * fLowEdges[k];
+    double hi = scale_ * fHighEdges[k];
+    for(size_t e = 0; e < fNE; e++){
+      double overlap = std::min(hi, fHighEdges[e]) - std::max(lo, fLowEdges[e]);
+      if(overlap > 0)
+        op_[e * fNE + k] = overlap / (hi - lo);
+    }
+  }
+}
+
+void
+EnergyMorph::ResolutionOperator(double resolution_, std::vector<double>& op_) const{
+  op_.assign(fNE * fNE, 0);
+  for(size_t k = 0; k < fNE; k++){
+    double centre = 0.5 * (fLowEdges[k] + fHighEdges[k]);
+    double sigma  = resolution_ * sqrt(std::max(centre, 0.));
+    if(sigma <= 0){
+      op_[k * fNE + k] = 1;
+      continue;
+    }
+    for(size_t e = 0; e < fNE; e++){
+      double w = 0.5 * (erf((fHighEdges[e] - centre)/(M_SQRT2 * sigma)) 
+                        - erf((fLowEdges[e] - centre)/(M_SQRT2 * sigma)));
+      if(w > 1e-12)
+        op_[e * fNE + k] = w;
+    }
+  }
+}
+
+void
+EnergyMorph::UpdateOperator(double scale_, double resolution_) const{
+  // only the factor that moved is rebuilt
+  if(scale_ != fScale){
+    ScaleOperator(scale_, fScaleOp);
+    fScale = scale_;
+  }
+  if(resolution_ != fResolution){
+    ResolutionOperator(resolution_, fResolutionOp);
+    fResolution = resolution_;
+  }
+
+  fOp.assign(fNE * fNE, 0);
+  for(size_t e = 0; e < fNE; e++)
+    for(size_t m = 0; m < fNE; m++){
+      double r = fResolutionOp[e * fNE + m];
+      if(!r)
+        continue;
+      for(size_t k = 0; k < fNE; k++)
+        fOp[e * fNE + k] += r * fScaleOp[m * fNE + k];
+    }
+
+  fBandFirst.assign(fNE, 0);
+  fBandLast.assign(fNE, 0);
+  for(size_t e = 0; e < fNE; e++){
+    size_t first = fNE;
+    size_t last  = 0;
+    for(size_t k = 0; k < fNE; k++)
+      if(fOp[e * fNE + k]){
+        first = std::min(first, k);
+        last  = k + 1;
+      }
+    fBandFirst[e] = std::min(first, last);
+    fBandLast[e]  = last;
+  }
+}
+
+std::vector<double>
+EnergyMorph::Operator(double scale_, double resolution_) const{
+  std::lock_guard<std::mutex> lock(fMutex);
+  UpdateOperator(scale_, resolution_);
+  return fOp;
+}
+
+std::shared_ptr<const EnergyMorph::Morphed>
+EnergyMorph::Apply(const double* probs_, size_t nPdfs_, double scale_, double resolution_,
+                   const std::vector<double>& inputKey_) const{
+  std::vector<double> op;
+  std::vector<size_t> first;
+  std::vector<size_t> last;
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    for(size_t i = 0; i < fRecent.size(); i++)
+      if(fRecent[i]->fScale == scale_ && fRecent[i]->fResolution == resolution_ 
+         && fRecent[i]->fInputKey == inputKey_)
+        return fRecent[i];
+
+    UpdateOperator(scale_, resolution_);
+    op = fOp;
+    first = fBandFirst;
+    last  = fBandLast;
+  }
+
+  // the expensive part, outside the lock
+  std::shared_ptr<Morphed> morphed(new Morphed);
+  morphed->fScale = scale_;
+  morphed->fResolution = resolution_;
+  morphed->fInputKey = inputKey_;
+  morphed->fProbs.assign(fNBins * nPdfs_, 0);
+  morphed->fTotals.assign(nPdfs_, 0);
+  for(size_t i = 0; i < fNBins; i++){
+    size_t e    = (i / fStride) % fNE;
+    size_t base = i - e * fStride;
+    double* out = &morphed->fProbs[i * nPdfs_];
+    for(size_t k = first[e]; k < last[e]; k++){
+      double w = op[e * fNE + k];
+      if(!w)
+        continue;
+      const double* in = probs_ + (base + k * fStride) * nPdfs_;
+      for(size_t j = 0; j < nPdfs_; j++)
+        out[j] += w * in[j];
+    }
+    for(size_t j = 0; j < nPdfs_; j++)
+      morphed->fTotals[j] += out[j];
+  }
+
+  std::lock_guard<std::mutex> lock(fMutex);
+  fRecent.push_front(morphed);
+  if(fRecent.size() > kMaxRecent)
+    fRecent.pop_back();
+  return morphed;
+}
+
+}
@@ -0,0 +1,70 @@
+// Energy scale and resolution systematics as operators on one axis of the 
+// pdfs. The scale maps E -> scale E, the resolution smears each bin with a 
+// gaussian of width resolution sqrt(E); the combined operator is banded, so
+// applying it costs a few bins per bin. Operators are rebuilt only for the 
+// factor that changed, and the last few morphed matrices are kept, so steps 
+// that only move the normalisations don't morph anything
+#ifndef __BBFIT__EnergyMorph__
+#define __BBFIT__EnergyMorph__
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+
+class AxisCollection;
+
+namespace bbfit{
+class EnergyMorph{
+public:
+  // the pdf matrix is laid out like axes_ and morphed along axis_
+  EnergyMorph(const AxisCollection& axes_, const std::string& axis_);
+
+  struct Morphed{
+    double fScale;
+    double fResolution;
+    std::vector<double> fInputKey;
+    std::vector<double> fProbs;  // same layout as the input
+    std::vector<double> fTotals; // column sums, probability can leave the range
+  };
+
+  // probs_ is bin major, nPdfs_ wide, and must be the same for every call 
+  // with the same inputKey_ (e.g. the template parameters that made it). 
+  // Safe to call from several threads
+  std::shared_ptr<const Morphed> Apply(const double* probs_, size_t nPdfs_,
+                                       double scale_, double resolution_,
+                                       const std::vector<double>& inputKey_ = std::vector<double>()) const;
+
+  // nE x nE, row is the bin moved to, column the bin moved from
+  std::vector<double> Operator(double scale_, double resolution_) const;
+
+  const std::string& GetAxisName() const;
+
+private:
+  EnergyMorph(const EnergyMorph&);
+  EnergyMorph& operator=(const EnergyMorph&);
+
+  void ScaleOperator(double scale_, std::vector<double>& op_) const;
+  void ResolutionOperator(double resolution_, std::vector<double>& op_) const;
+  void UpdateOperator(double scale_, double resolution_) const;
+
+  std::string fAxisName;
+  size_t fNE;
+  size_t fStride;
+  size_t fNBins;
+  std::vector<double> fLowEdges;
+  std::vector<double> fHighEdges;
+
+  mutable std::mutex fMutex;
+  mutable double fScale;
+  mutable double fResolution;
+  mutable std::vector<double> fScaleOp;
+  mutable std::vector<double> fResolutionOp;
+  mutable std::vector<double> fOp;  // fResolutionOp x fScaleOp
+  mutable std::vector<size_t> fBandFirst; // non-zero columns of each row of fOp
+  mutable std::vector<size_t> fBandLast;
+  mutable std::deque<std::shared_ptr<const Morphed> > fRecent;
+};
+}
+#endif
@@ -110,4 +110,15 @@ void
 EventConfig::SetRandomSplit(bool b_){
   fRandomSplit = b_;
 }
+
+bool
+EventConfig::GetPrePruned() const{
+  return fPrePruned;
+}
+
+void
+EventConfig::SetPrePruned(bool b_){
+  fPrePruned = b_;
+}
+
 }
@@ -6,7 +6,7 @@
 namespace bbfit{
 class EventConfig{
 public:
-  EventConfig(): fRate(-1), fNgenerated(0) {}
+  EventConfig(): fRate(-1), fNgenerated(0), fPrePruned(false) {}
 
   double GetRate() const;
   void   SetRate(double);
@@ -41,6 +41,10 @@ public:
   bool GetRandomSplit() const;
   void SetRandomSplit(bool);
 
+  // the pruned ntuple is written by data_manip/clean_and_prune, not make_trees
+  bool GetPrePruned() const;
+  void SetPrePruned(bool);
+
 private:
   double fRate;
   unsigned long  fNgenerated;
@@ -53,6 +57,7 @@ private:
   std::string fName;
   std::string fLoadingScaling;
   bool fRandomSplit;
+  bool fPrePruned;
 };
 }
 
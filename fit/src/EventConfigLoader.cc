@@ -48,6 +48,15 @@ EventConfigLoader::LoadOne(const std::string& name_) const{
   }
 
 
+  // bipos and alpha-ns are cleaned and pruned in one pass by data_manip/clean_and_prune
+  std::string prePruned;
+  try{
+      ConfigLoader::Load(name_, "prepruned", prePruned);
+  }
+  catch(const ConfigFieldMissing&){
+      prePruned = "false";
+  }
+
   if(splitMethod == "random")
     randomSplit = true;
   else if(splitMethod == "sequential")
@@ -67,6 +76,7 @@ EventConfigLoader::LoadOne(const std::string& name_) const{
   retVal.SetSplitPdfPath(splitDirPdf + "/" + name_ + ".root");
   retVal.SetRandomSplit(randomSplit);
   retVal.SetLoadingScaling(scalesWithLoading);
+  retVal.SetPrePruned(prePruned == "true");
   return retVal;
 }
 
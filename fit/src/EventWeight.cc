@@ -0,0 +1,66 @@
+#include <EventWeight.hh>
+#include <DataSet.h>
+#include <Exceptions.h>
+#include <algorithm>
+#include <cstdlib>
+
+namespace bbfit{
+
+EventWeight::EventWeight(const std::string& expression_) : fExpression(expression_), fConstant(1){
+  std::string expr = expression_;
+  expr.erase(std::remove(expr.begin(), expr.end(), ' '), expr.end());
+  if(expr.empty())
+    throw ValueError("EventWeight:: empty weight expression");
+
+  size_t start = 0;
+  while(start <= expr.size()){
+    size_t end = expr.find('*', start);
+    if(end == std::string::npos)
+      end = expr.size();
+    std::string factor = expr.substr(start, end - start);
+    if(factor.empty())
+      throw ValueError("EventWeight:: can't parse weight expression " + expression_);
+
+    // numbers multiply in, anything else is a branch
+    char* parsed;
+    double val = strtod(factor.c_str(), &parsed);
+    if(*parsed == '\0')
+      fConstant *= val;
+    else
+      fColumns.push_back(factor);
+    start = end + 1;
+  }
+}
+
+const std::string&
+EventWeight::GetExpression() const{
+  return fExpression;
+}
+
+const std::vector<std::string>&
+EventWeight::GetColumns() const{
+  return fColumns;
+}
+
+std::vector<size_t>
+EventWeight::Resolve(const DataSet& data_) const{
+  std::vector<std::string> obs = data_.GetObservableNames();
+  std::vector<size_t> indices;
+  for(size_t i = 0; i < fColumns.size(); i++){
+    std::vector<std::string>::iterator it = std::find(obs.begin(), obs.end(), fColumns.at(i));
+    if(it == obs.end())
+      throw NotFoundError("EventWeight:: data set has no weight branch " + fColumns.at(i));
+    indices.push_back(it - obs.begin());
+  }
+  return indices;
+}
+
+double
+EventWeight::Evaluate(const std::vector<double>& values_, const std::vector<size_t>& indices_) const{
+  double w = fConstant;
+  for(size_t i = 0; i < indices_.size(); i++)
+    w *= values_[indices_[i]];
+  return w;
+}
+
+}
@@ -0,0 +1,31 @@
+#ifndef __BBFIT__EventWeight__
+#define __BBFIT__EventWeight__
+#include <string>
+#include <vector>
+#include <cstddef>
+
+class DataSet;
+
+// per event weight from the dist config: a branch of the pruned ntuple, a
+// number, or a product of them, e.g. "w_spectrum*w_loading*0.5"
+namespace bbfit{
+class EventWeight{
+public:
+  EventWeight(const std::string& expression_);
+
+  const std::string& GetExpression() const;
+  const std::vector<std::string>& GetColumns() const;
+
+  // where the columns are in data_'s events
+  std::vector<size_t> Resolve(const DataSet& data_) const;
+
+  // values_ is an event's data, indices_ from Resolve
+  double Evaluate(const std::vector<double>& values_, const std::vector<size_t>& indices_) const;
+
+private:
+  std::string fExpression;
+  std::vector<std::string> fColumns;
+  double fConstant;
+};
+}
+#endif
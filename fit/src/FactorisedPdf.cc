@@ -0,0 +1,186 @@
+#include <FactorisedPdf.hh>
+#include <BinnedED.h>
+#include <IO.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <algorithm>
+
+namespace bbfit{
+
+static bool
+Contains(const std::vector<std::string>& names_, const std::string& name_){
+  return std::find(names_.begin(), names_.end(), name_) != names_.end();
+}
+
+// the position in from_ of each axis of to_, both must have it with the same binning
+static std::vector<size_t>
+AxisMap(const AxisCollection& to_, const AxisCollection& from_, const std::string& what_){
+  std::vector<std::string> fromNames = from_.GetAxisNames();
+  std::vector<size_t> positions;
+  for(size_t d = 0; d < to_.GetNDimensions(); d++){
+    const BinAxis& axis = to_.GetAxis(d);
+    std::vector<std::string>::const_iterator it = std::find(fromNames.begin(), fromNames.end(), 
+                                                            axis.GetName());
+    if(it == fromNames.end())
+      throw NotFoundError("FactorisedPdf:: " + what_ + " has no axis " + axis.GetName());
+    size_t pos = it - fromNames.begin();
+    if(from_.GetAxis(pos).GetNBins() != axis.GetNBins())
+      throw DimensionError(Formatter() << "FactorisedPdf:: axis " << axis.GetName() << " has "
+                           << axis.GetNBins() << " bins, " << what_ << " has " 
+                           << from_.GetAxis(pos).GetNBins());
+    positions.push_back(pos);
+  }
+  return positions;
+}
+
+Histogram
+FactorisedPdf::Project(const Histogram& hist_, const std::vector<std::string>& keep_){
+  const AxisCollection& axes = hist_.GetAxes();
+  AxisCollection kept;
+  for(size_t d = 0; d < axes.GetNDimensions(); d++)
+    if(Contains(keep_, axes.GetAxis(d).GetName()))
+      kept.AddAxis(axes.GetAxis(d));
+
+  Histogram projected(kept);
+  std::vector<size_t> positions = AxisMap(kept, axes, "projected histogram");
+  std::vector<size_t> indices(positions.size());
+  for(size_t i = 0; i < hist_.GetNBins(); i++){
+    for(size_t d = 0; d < positions.size(); d++)
+      indices[d] = axes.UnflattenIndex(i, positions[d]);
+    projected.AddBinContent(kept.FlattenIndices(indices), hist_.GetBinContent(i));
+  }
+  return projected;
+}
+
+FactorisedPdf::FactorisedPdf(const std::string& name_, const Histogram& marginal_, 
+                             const Histogram& conditional_) : fName(name_), fMarginal(marginal_),
+                                                              fConditional(conditional_){
+  std::vector<std::string> marginalNames = marginal_.GetAxisNames();
+  std::vector<std::string> condNames     = conditional_.GetAxisNames();
+  for(size_t i = 0; i < condNames.size(); i++)
+    if(Contains(marginalNames, condNames.at(i)))
+      fCondAxes.push_back(condNames.at(i));
+
+  if(fMarginal.Integral())
+    fMarginal.Normalise();
+
+  // g sums to one for each conditioning bin, flat where there's nothing to go on
+  if(fCondAxes.empty()){
+    if(fConditional.Integral())
+      fConditional.Normalise();
+    return;
+  }
+  Histogram condSums = Project(fConditional, fCondAxes);
+  const AxisCollection& axes = fConditional.GetAxes();
+  std::vector<size_t> positions = AxisMap(condSums.GetAxes(), axes, "conditional factor");
+  std::vector<size_t> indices(positions.size());
+  double perCondBin = double(condSums.GetNBins()) / fConditional.GetNBins();
+  for(size_t i = 0; i < fConditional.GetNBins(); i++){
+    for(size_t d = 0; d < positions.size(); d++)
+      indices[d] = axes.UnflattenIndex(i, positions[d]);
+    double sum = condSums.GetBinContent(condSums.GetAxes().FlattenIndices(indices));
+    fConditional.SetBinContent(i, sum ? fConditional.GetBinContent(i)/sum : perCondBin);
+  }
+}
+
+FactorisedPdf
+FactorisedPdf::Factorise(const BinnedED& dense_, const std::vector<std::string>& marginalAxes_,
+                         const std::vector<std::string>& condAxes_){
+  std::vector<std::string> condKeep;
+  std::vector<std::string> names = dense_.GetAxes().GetAxisNames();
+  for(size_t i = 0; i < names.size(); i++)
+    if(!Contains(marginalAxes_, names.at(i)) || Contains(condAxes_, names.at(i)))
+      condKeep.push_back(names.at(i));
+
+  for(size_t i = 0; i < condAxes_.size(); i++)
+    if(!Contains(marginalAxes_, condAxes_.at(i)))
+      throw ValueError("FactorisedPdf::Factorise conditioning axis " + condAxes_.at(i) 
+                       + " must also be a marginal axis");
+
+  return FactorisedPdf(dense_.GetName(), Project(dense_.GetHistogram(), marginalAxes_),
+                       Project(dense_.GetHistogram(), condKeep));
+}
+
+const std::string&
+FactorisedPdf::GetName() const{
+  return fName;
+}
+
+const Histogram&
+FactorisedPdf::GetMarginal() const{
+  return fMarginal;
+}
+
+const Histogram&
+FactorisedPdf::GetConditional() const{
+  return fConditional;
+}
+
+const std::vector<std::string>&
+FactorisedPdf::GetConditioningAxes() const{
+  return fCondAxes;
+}
+
+FactorisedPdf
+FactorisedPdf::Marginalise(const std::vector<std::string>& keep_) const{
+  for(size_t i = 0; i < fCondAxes.size(); i++)
+    if(!Contains(keep_, fCondAxes.at(i)))
+      throw ValueError("FactorisedPdf::Marginalise can't sum out the conditioning axis " 
+                       + fCondAxes.at(i) + " of " + fName);
+  return FactorisedPdf(fName, Project(fMarginal, keep_), Project(fConditional, keep_));
+}
+
+void
+FactorisedPdf::MapBins(const AxisCollection& axes_, std::vector<unsigned>& marginalBins_,
+                       std::vector<unsigned>& conditionalBins_) const{
+  const AxisCollection& margAxes = fMarginal.GetAxes();
+  const AxisCollection& condAxes = fConditional.GetAxes();
+  std::vector<size_t> margPos = AxisMap(margAxes, axes_, "the data");
+  std::vector<size_t> condPos = AxisMap(condAxes, axes_, "the data");
+
+  // and nothing in the data is left unaccounted for
+  for(size_t d = 0; d < axes_.GetNDimensions(); d++)
+    if(std::find(margPos.begin(), margPos.end(), d) == margPos.end() &&
+       std::find(condPos.begin(), condPos.end(), d) == condPos.end())
+      throw NotFoundError("FactorisedPdf:: " + fName + " has no axis " + axes_.GetAxis(d).GetName());
+
+  size_t nBins = axes_.GetNBins();
+  marginalBins_.resize(nBins);
+  conditionalBins_.resize(nBins);
+  std::vector<size_t> margIdx(margPos.size());
+  std::vector<size_t> condIdx(condPos.size());
+  for(size_t i = 0; i < nBins; i++){
+    for(size_t d = 0; d < margPos.size(); d++)
+      margIdx[d] = axes_.UnflattenIndex(i, margPos[d]);
+    for(size_t d = 0; d < condPos.size(); d++)
+      condIdx[d] = axes_.UnflattenIndex(i, condPos[d]);
+    marginalBins_[i]    = margAxes.FlattenIndices(margIdx);
+    conditionalBins_[i] = condAxes.FlattenIndices(condIdx);
+  }
+}
+
+BinnedED
+FactorisedPdf::Dense(const AxisCollection& axes_) const{
+  std::vector<unsigned> margBins;
+  std::vector<unsigned> condBins;
+  MapBins(axes_, margBins, condBins);
+
+  BinnedED dense(fName, axes_);
+  for(size_t i = 0; i < margBins.size(); i++)
+    dense.SetBinContent(i, fMarginal.GetBinContent(margBins[i]) * fConditional.GetBinContent(condBins[i]));
+  return dense;
+}
+
+void
+FactorisedPdf::Save(const std::string& dir_) const{
+  IO::SaveHistogram(fMarginal, dir_ + "/" + fName + ".marginal.h5");
+  IO::SaveHistogram(fConditional, dir_ + "/" + fName + ".conditional.h5");
+}
+
+FactorisedPdf
+FactorisedPdf::Load(const std::string& dir_, const std::string& name_){
+  return FactorisedPdf(name_, IO::LoadHistogram(dir_ + "/" + name_ + ".marginal.h5"),
+                       IO::LoadHistogram(dir_ + "/" + name_ + ".conditional.h5"));
+}
+
+}
@@ -0,0 +1,56 @@
+// A pdf stored as the product of two smaller histograms, 
+//     p(x, c, y) = f(x, c) g(y | c)
+// e.g. f(energy, r) g(timePSD, anglePSD | r). The conditioning axes c are the 
+// ones the two factors share; g sums to one over y for every bin of c. Memory 
+// goes with the sum of the factor sizes rather than their product
+#ifndef __BBFIT__FactorisedPdf__
+#define __BBFIT__FactorisedPdf__
+#include <Histogram.h>
+#include <string>
+#include <vector>
+
+class BinnedED;
+
+namespace bbfit{
+class FactorisedPdf{
+public:
+  FactorisedPdf() {}
+  // normalises both factors
+  FactorisedPdf(const std::string& name_, const Histogram& marginal_, const Histogram& conditional_);
+
+  // f is dense_ summed over everything but marginalAxes_, g is dense_ summed over
+  // everything in marginalAxes_ but condAxes_, normalised per condAxes_ bin
+  static FactorisedPdf Factorise(const BinnedED& dense_, 
+                                 const std::vector<std::string>& marginalAxes_,
+                                 const std::vector<std::string>& condAxes_);
+
+  const std::string& GetName() const;
+  const Histogram& GetMarginal() const;
+  const Histogram& GetConditional() const;
+  const std::vector<std::string>& GetConditioningAxes() const;
+
+  // sum out the axes not in keep_, the conditioning axes can't be dropped
+  FactorisedPdf Marginalise(const std::vector<std::string>& keep_) const;
+
+  // for every bin of axes_, the two factor bins whose product it is
+  void MapBins(const AxisCollection& axes_, std::vector<unsigned>& marginalBins_,
+               std::vector<unsigned>& conditionalBins_) const;
+
+  // the product written out over axes_, for output only
+  BinnedED Dense(const AxisCollection& axes_) const;
+
+  // as dir_/<name>.marginal.h5 and dir_/<name>.conditional.h5
+  void Save(const std::string& dir_) const;
+  static FactorisedPdf Load(const std::string& dir_, const std::string& name_);
+
+  // hist_ summed over every axis not in keep_, axes stay in hist_'s order
+  static Histogram Project(const Histogram& hist_, const std::vector<std::string>& keep_);
+
+private:
+  std::string fName;
+  Histogram   fMarginal;
+  Histogram   fConditional;
+  std::vector<std::string> fCondAxes;
+};
+}
+#endif
@@ -1,24 +1,25 @@
 #include "FitConfig.hh"
 #include <ContainerTools.hpp> 
+#include <Exceptions.h>
 
 namespace bbfit{
 
-ParameterDict 
+const ParameterDict&
 FitConfig::GetMinima() const{
   return fMinima;
 }
 
-ParameterDict
+const ParameterDict&
 FitConfig::GetMaxima() const{
   return fMaxima;
 }
 
-ParameterDict
+const ParameterDict&
 FitConfig::GetSigmas() const{
   return fSigmas;
 }
 
-ParameterDict
+const ParameterDict&
 FitConfig::GetNBins() const{
   return fNbins;
 }
@@ -56,6 +57,44 @@ FitConfig::GetParamNames() const{
   return ContainerTools::GetKeys(fMinima);
 }
 
+void
+FitConfig::SetSystematic(const std::string& name_, const std::string& type_, const std::string& axis_){
+  if(type_ != "energy_scale" && type_ != "energy_resolution")
+    throw ValueError("FitConfig::Unknown systematic type " + type_ + " for " + name_);
+  fSystematicTypes[name_] = type_;
+  fSystematicAxes[name_]  = axis_;
+}
+
+const std::map<std::string, std::string>&
+FitConfig::GetSystematicTypes() const{
+  return fSystematicTypes;
+}
+
+const std::map<std::string, std::string>&
+FitConfig::GetSystematicAxes() const{
+  return fSystematicAxes;
+}
+
+void
+FitConfig::SetTemplate(const std::string& name_, const TemplateConfig& config_){
+  fSystematicTypes[name_] = "template";
+  fTemplates[name_] = config_;
+}
+
+const std::map<std::string, TemplateConfig>&
+FitConfig::GetTemplates() const{
+  return fTemplates;
+}
+
+std::set<std::string>
+FitConfig::GetDistNames() const{
+  std::set<std::string> names = GetParamNames();
+  for(std::map<std::string, std::string>::const_iterator it = fSystematicTypes.begin();
+      it != fSystematicTypes.end(); ++it)
+    names.erase(it->first);
+  return names;
+}
+
 const std::string&
 FitConfig::GetOutDir() const{
     return fOutDir;
@@ -87,6 +126,16 @@ FitConfig::SetEpsilon(double e_){
 }
 
 
+bool
+FitConfig::GetBarlowBeeston() const{
+    return fBarlowBeeston;
+}
+
+void
+FitConfig::SetBarlowBeeston(bool b_){
+    fBarlowBeeston = b_;
+}
+
 void 
 FitConfig::AddParameter(const std::string& name_, double min_, double max_, double sigma_, int nbins_, 
                         double constrMean_, double constrSigma_){
@@ -97,12 +146,12 @@ FitConfig::AddParameter(const std::string& name_, double min_, double max_, doub
     AddParameter(name_, min_, max_, sigma_, nbins_);
 }
 
-ParameterDict
+const ParameterDict&
 FitConfig::GetConstrMeans() const{
     return fConstrMeans;
 }
 
-ParameterDict
+const ParameterDict&
 FitConfig::GetConstrSigmas() const{
     return fConstrSigmas;
 }
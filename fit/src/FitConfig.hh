@@ -1,19 +1,23 @@
  #ifndef __BBFIT__FitConfig__
 #define __BBFIT__FitConfig__
 #include <ParameterDict.h>
+#include <TemplateConfig.hh>
 #include <string>
 #include <set>
+#include <map>
 
 namespace bbfit{
 class FitConfig{
 public:
-  ParameterDict GetMinima() const;
-  ParameterDict GetMaxima() const;
-  ParameterDict GetSigmas() const;
-  ParameterDict GetNBins() const;
+  FitConfig() : fBarlowBeeston(false) {}
+
+  const ParameterDict& GetMinima() const;
+  const ParameterDict& GetMaxima() const;
+  const ParameterDict& GetSigmas() const;
+  const ParameterDict& GetNBins() const;
   
-  ParameterDict GetConstrMeans() const;
-  ParameterDict GetConstrSigmas() const;
+  const ParameterDict& GetConstrMeans() const;
+  const ParameterDict& GetConstrSigmas() const;
 
   int  GetIterations() const;
   void SetIterations(int);
@@ -26,6 +30,19 @@ public:
                     double constrMean_, double constrSigma_);
 
   std::set<std::string> GetParamNames() const;
+
+  // parameters that morph the pdfs along axis_ instead of normalising one,
+  // type_ is energy_scale or energy_resolution
+  void SetSystematic(const std::string& name_, const std::string& type_, const std::string& axis_);
+  const std::map<std::string, std::string>& GetSystematicTypes() const;
+  const std::map<std::string, std::string>& GetSystematicAxes() const;
+
+  // type template: interpolates pdfs between sets built at a grid of values
+  void SetTemplate(const std::string& name_, const TemplateConfig&);
+  const std::map<std::string, TemplateConfig>& GetTemplates() const;
+
+  // the parameters that are pdf normalisations, i.e. all but the systematics
+  std::set<std::string> GetDistNames() const;
   
   const std::string& GetOutDir() const;
   void  SetOutDir(const std::string&);
@@ -36,6 +53,10 @@ public:
   double GetEpsilon() const;
   void   SetEpsilon(double);
 
+  // per bin MC statistical uncertainty from the raw counts make_pdfs saves
+  bool GetBarlowBeeston() const;
+  void SetBarlowBeeston(bool);
+
 private:
   std::string   fOutDir;
   ParameterDict fConstrMeans;
@@ -44,10 +65,14 @@ private:
   ParameterDict fMaxima;
   ParameterDict fSigmas;
   ParameterDict fNbins;
+  std::map<std::string, std::string> fSystematicTypes;
+  std::map<std::string, std::string> fSystematicAxes;
+  std::map<std::string, TemplateConfig> fTemplates;
   int       fIterations;
   int       fBurnIn;
   int       fNsteps;
   double    fEpsilon;
+  bool      fBarlowBeeston;
    
 };
 }
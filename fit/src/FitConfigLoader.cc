@@ -37,6 +37,14 @@ FitConfigLoader::LoadActive() const{
   ret.SetEpsilon(epsilon);
   ret.SetIterations(it);
   ret.SetBurnIn(burnIn);
+
+  // optional, off unless asked for
+  try{
+    std::string bb;
+    ConfigLoader::Load("summary", "barlow_beeston", bb);
+    ret.SetBarlowBeeston(bb == "true");
+  }
+  catch(const ConfigFieldMissing& e_){}
   
   typedef std::set<std::string> StringSet;
   StringSet toLoad;
@@ -70,6 +78,47 @@ FitConfigLoader::LoadActive() const{
     catch(const ConfigFieldMissing& e_){
         ret.AddParameter(name, min, max, sig, nbins);
     }
+
+    // energy_scale/energy_resolution rather than a normalisation
+    std::string type;
+    try{
+        ConfigLoader::Load(name, "type", type);
+    }
+    catch(const ConfigFieldMissing& e_){
+        continue;
+    }
+    if(type == "template"){
+        std::vector<std::string> dirs;
+        std::vector<double> values;
+        ConfigLoader::Load(name, "variant_dirs", dirs);
+        ConfigLoader::Load(name, "variant_values", values);
+
+        TemplateConfig templ;
+        templ.SetGrid(dirs, values);
+        try{
+            std::vector<std::string> pdfs;
+            ConfigLoader::Load(name, "pdfs", pdfs);
+            templ.SetPdfs(pdfs);
+        }
+        catch(const ConfigFieldMissing& e_){}
+        try{
+            std::string interp;
+            ConfigLoader::Load(name, "interpolation", interp);
+            if(interp != "linear" && interp != "exponential")
+                throw ValueError("FitConfigLoader:: interpolation for " + name + " must be linear or exponential");
+            templ.SetExponential(interp == "exponential");
+        }
+        catch(const ConfigFieldMissing& e_){}
+        ret.SetTemplate(name, templ);
+        continue;
+    }
+
+    std::string axis = "energy";
+    try{
+        ConfigLoader::Load(name, "axis", axis);
+    }
+    catch(const ConfigFieldMissing& e_){}
+    ret.SetSystematic(name, type, axis);
   }
 
   return ret;
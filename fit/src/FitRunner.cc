@@ -0,0 +1,121 @@
+#include <FitRunner.hh>
+#include <IndexedLikelihood.hh>
+#include <BoundedBFGS.hh>
+#include <IndexedHMC.hh>
+#include <WarmStart.hh>
+#include <LaplaceApproximation.hh>
+#include <OutputContainer.hh>
+#include <IO.h>
+#include <fstream>
+#include <cstdio>
+#include <iostream>
+#include <sys/stat.h>
+
+namespace bbfit{
+
+// warm started chains check for the typical set this often during the burn in
+static const int kBurnInWindow = 50;
+
+FitRunner::Result
+FitRunner::RunMAP(const IndexedLikelihood& lh_, const ParameterLayout& layout_,
+                  std::vector<double> start_, const std::string& covariancePath_){
+  Result result;
+  BoundedBFGS minimiser(lh_, layout_);
+  result.fBestFitNLLH = minimiser.Minimise(start_);
+  result.fBestFit = start_;
+  std::cout << "Minimisation " << (minimiser.GetConverged() ? "converged" : "did not converge")
+            << " after " << minimiser.GetIterations() << " iterations" << std::endl;
+
+  std::vector<double> hessian;
+  lh_.EvaluateHessian(&start_[0], hessian);
+  LaplaceApproximation laplace(layout_, start_, hessian);
+  laplace.SaveCovariance(covariancePath_);
+  result.f1DProjections = laplace.Get1DProjections();
+  result.f2DProjections = laplace.Get2DProjections();
+  return result;
+}
+
+FitRunner::Result
+FitRunner::RunHMC(const IndexedLikelihood& lh_, const ParameterLayout& layout_,
+                  double epsilon_, int nSteps_, int iterations_, int burnIn_,
+                  const WarmStart* warm_, const std::string& covariancePath_){
+  // masses default to 1/sigma^2
+  double epsilon = epsilon_;
+  if(warm_)
+    epsilon = warm_->GetEpsilon(epsilon, nSteps_);
+  IndexedHMC sampler(lh_, layout_, epsilon, nSteps_);
+  sampler.SetMaxIter(iterations_);
+  sampler.SetBurnIn(burnIn_);
+
+  // the burn in is there to find the posterior, a warm start is already 
+  // in it, so it can usually stop early
+  if(warm_){
+    sampler.SetInitialPoint(warm_->GetInitialPoint());
+    if(warm_->HasCovariance())
+      sampler.SetMasses(warm_->GetMasses());
+    // parameters that didn't start at the earlier mode need a window to move
+    sampler.SetAutoBurnIn(kBurnInWindow, warm_->GetNAdjusted() ? 1 : 0);
+    std::cout << "Step size " << epsilon << std::endl;
+  }
+
+  sampler.Run();
+  Result result;
+  result.fBestFit           = sampler.GetBestFit();
+  result.fBestFitNLLH       = sampler.GetBestFitNLLH();
+  result.f1DProjections     = sampler.Get1DProjections();
+  result.f2DProjections     = sampler.Get2DProjections();
+  result.fAutoCorrelations  = sampler.GetAutoCorrelations();
+  std::cout << "Acceptance rate : " << sampler.GetAcceptanceRate() << std::endl;
+  std::cout << "Burn in : " << sampler.GetBurnInUsed() << std::endl;
+
+  // a covariance of zeros would warm start the next fit with infinite masses,
+  // and a stale one from an earlier run into this directory would be worse
+  if(sampler.GetNSamples() < 2){
+    std::remove(covariancePath_.c_str());
+    std::cout << "Only " << sampler.GetNSamples() << " samples, not saving a covariance" << std::endl;
+  }
+  else
+    LaplaceApproximation::SaveCovariance(layout_, sampler.GetSampleCovariance(), covariancePath_);
+  return result;
+}
+
+std::vector<double>
+FitRunner::BoxCentre(const ParameterLayout& layout_){
+  std::vector<double> x(layout_.GetNParams());
+  for(size_t i = 0; i < x.size(); i++)
+    x[i] = 0.5 * (layout_.GetMinima()[i] + layout_.GetMaxima()[i]);
+  return x;
+}
+
+void
+FitRunner::MakeDir(const std::string& dir_){
+  struct stat st = {0};
+  if(stat(dir_.c_str(), &st) == -1)
+    mkdir(dir_.c_str(), 0700);
+}
+
+void
+FitRunner::SaveHists(const HistMap& hists_, const std::string& dir_, bool container_){
+  if(container_){
+    OutputContainer out(OutputContainer::PathFor(dir_));
+    for(HistMap::const_iterator it = hists_.begin(); it != hists_.end(); ++it)
+      out.Add(it->first, it->second);
+    return;
+  }
+  for(HistMap::const_iterator it = hists_.begin(); it != hists_.end(); ++it)
+    IO::SaveHistogram(it->second, dir_ + "/" + it->first + ".root");
+}
+
+void
+FitRunner::SaveResult(const Result& result_, const ParameterLayout& layout_, 
+                      const std::string& path_){
+  ParameterDict bestFit = layout_.ToDict(result_.fBestFit);
+  std::ofstream rofs(path_.c_str());
+  rofs << "Best fit -log(lh) : " << result_.fBestFitNLLH << "\n\n";
+  for(ParameterDict::iterator it = bestFit.begin(); it != bestFit.end(); ++it)
+    rofs << it->first << "\t" << it->second << "\n";
+  rofs.close();
+  std::cout << "Saved fit result to " << path_ << std::endl;
+}
+
+}
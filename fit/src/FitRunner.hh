@@ -0,0 +1,55 @@
+#ifndef __BBFIT__FitRunner__
+#define __BBFIT__FitRunner__
+#include <ParameterLayout.hh>
+#include <Histogram.h>
+#include <vector>
+#include <string>
+#include <map>
+
+// What fit_dataset and fit_combined do once they have a likelihood: find the 
+// mode or sample the posterior, and write the results out the same way
+
+namespace bbfit{
+class IndexedLikelihood;
+class WarmStart;
+
+class FitRunner{
+public:
+  typedef std::map<std::string, Histogram> HistMap;
+
+  struct Result{
+    Result() : fBestFitNLLH(0) {}
+    std::vector<double> fBestFit;
+    double              fBestFitNLLH;
+    HistMap             f1DProjections;
+    HistMap             f2DProjections;
+    std::vector<double> fAutoCorrelations; // empty for a MAP fit
+  };
+
+  // minimise from start_, then approximate the posterior with a gaussian 
+  // around the mode, whose covariance goes to covariancePath_
+  static Result RunMAP(const IndexedLikelihood& lh_, const ParameterLayout& layout_,
+                       std::vector<double> start_, const std::string& covariancePath_);
+
+  // sample with HMC, from warm_'s point, masses and step size if there is 
+  // one, with the burn in ending early once the chain is typical. The sample 
+  // covariance goes to covariancePath_ so this fit can warm start the next
+  static Result RunHMC(const IndexedLikelihood& lh_, const ParameterLayout& layout_,
+                       double epsilon_, int nSteps_, int iterations_, int burnIn_,
+                       const WarmStart* warm_, const std::string& covariancePath_);
+
+  // middle of the box, the binned lh is convex in the normalisations so it 
+  // doesn't matter much where the minimiser starts
+  static std::vector<double> BoxCentre(const ParameterLayout& layout_);
+
+  static void MakeDir(const std::string& dir_);
+
+  // one file per histogram, or all of them in a single container standing in for dir_
+  static void SaveHists(const HistMap& hists_, const std::string& dir_, bool container_);
+
+  // fit_result.txt: the best fit -log(lh), then name\tvalue
+  static void SaveResult(const Result& result_, const ParameterLayout& layout_, 
+                         const std::string& path_);
+};
+}
+#endif
@@ -0,0 +1,285 @@
+#include <FitSetup.hh>
+#include <FitConfigLoader.hh>
+#include <DistConfigLoader.hh>
+#include <CutConfigLoader.hh>
+#include <CutFactory.hh>
+#include <DistBuilder.hh>
+#include <PdfBundle.hh>
+#include <SharedPdfStore.hh>
+#include <FactorisedPdf.hh>
+#include <CutCollection.h>
+#include <CutLog.h>
+#include <IO.h>
+#include <Exceptions.h>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+
+namespace bbfit{
+
+// everything the shared pdfs depend on: which pdfs and the files they came from
+static std::string
+SharedPdfKey(const DistConfig& config_, const std::set<std::string>& names_){
+  std::ostringstream ss;
+  ss << config_.GetPDFDir() << "|" << config_.GetBundle();
+  for(std::set<std::string>::const_iterator it = names_.begin(); it != names_.end(); ++it){
+    std::string path = config_.GetBundle() ? PdfBundle::BundlePath(config_.GetPDFDir()) 
+                                           : config_.GetPDFDir() + "/" + *it + ".h5";
+    // a missing file would give every missing setup the same key
+    struct stat st = {0};
+    if(stat(path.c_str(), &st) == -1)
+      throw NotFoundError("FitSetup:: no pdf file at " + path + " to share");
+    ss << ";" << *it << "|" << st.st_size << "|" << st.st_mtime;
+  }
+  return ss.str();
+}
+
+FitSetup::FitSetup(const std::string& fitConfigFile_, const std::string& distConfigFile_,
+                   const std::string& cutConfigFile_, const std::string& dataPath_,
+                   const std::string& dims_, bool sharePdfs_){
+  // Load up the configuration data
+  typedef std::vector<CutConfig> CutVec;
+  CutVec cutConfs;
+  bool useCutIndex;
+  bool adaptiveOrder;
+  {
+    FitConfigLoader mcLoader(fitConfigFile_);
+    fFitConfig = mcLoader.LoadActive();
+
+    CutConfigLoader cutConfLoader(cutConfigFile_);
+    cutConfs = cutConfLoader.LoadActive();
+    useCutIndex = cutConfLoader.LoadUseCutIndex();
+    adaptiveOrder = cutConfLoader.LoadAdaptiveOrder();
+  }
+  CutCollection cutCol = CutFactory::BuildCollection(cutConfs);
+
+  // Load up the dists
+  {
+    DistConfigLoader dLoader(distConfigFile_);
+    fDistConfig = dLoader.Load();
+  }
+
+  // the ones you actually want to fit are those listed in the fit config
+  typedef std::set<std::string> StringSet;
+  StringSet distsToFit = fFitConfig.GetDistNames();
+  if(fDistConfig.GetFactorised()){
+    if(sharePdfs_)
+      throw ValueError("FitSetup:: factorised pdfs can't go in the shared pdf store");
+    for(StringSet::iterator it = distsToFit.begin(); it != distsToFit.end(); ++it)
+      fFactorised.push_back(FactorisedPdf::Load(fDistConfig.GetPDFDir(), *it));
+  }
+  else if(sharePdfs_){
+    // the first fit on the node loads and publishes, the rest just map it
+    // owned from here, so a throw below still releases the create lock
+    fStore.reset(new SharedPdfStore(SharedPdfKey(fDistConfig, distsToFit)));
+    if(fStore->IsAttached())
+      std::cout << "Attached to shared pdfs " << fStore->GetSegmentName() << std::endl;
+    else{
+      LoadDists(distsToFit);
+      std::vector<std::string> names;
+      for(size_t i = 0; i < fDists.size(); i++)
+        names.push_back(fDists.at(i).GetName());
+      size_t nBins = fDists.empty() ? 0 : fDists.at(0).GetNBins();
+      fStore->Publish(names, nBins, IndexedBinnedNLLH::BuildProbs(fDists, nBins));
+      fDists.clear();
+      std::cout << "Published shared pdfs " << fStore->GetSegmentName() << std::endl;
+    }
+  }
+  else
+    LoadDists(distsToFit);
+
+  if(fFitConfig.GetBarlowBeeston()){
+    for(StringSet::iterator it = distsToFit.begin(); it != distsToFit.end(); ++it){
+      std::string countPath = fDistConfig.GetPDFDir() + "/" + *it + ".counts.h5";
+      struct stat st = {0};
+      if(stat(countPath.c_str(), &st) == -1)
+        throw NotFoundError("FitSetup:: no MC counts for " + *it + " at " + countPath 
+                            + ", rerun make_pdfs or switch off barlow_beeston");
+      BinnedED counts(*it, IO::LoadHistogram(countPath));
+
+      // weighted pdfs: the effective number of events, (sum w)^2/sum w^2
+      std::string sumW2Path = fDistConfig.GetPDFDir() + "/" + *it + ".sumw2.h5";
+      if(stat(sumW2Path.c_str(), &st) != -1){
+        Histogram sumW2 = IO::LoadHistogram(sumW2Path);
+        for(size_t i = 0; i < counts.GetNBins(); i++){
+          double w = counts.GetBinContent(i);
+          double w2 = sumW2.GetBinContent(i);
+          counts.SetBinContent(i, w2 > 0 ? w * w/w2 : 0);
+        }
+      }
+      fCountNames.push_back(*it);
+      fCounts.push_back(counts);
+    }
+  }
+
+  // the variants for template parameters, every grid point's pdf dir laid out like this one
+  typedef std::map<std::string, TemplateConfig> TemplateMap;
+  const TemplateMap& templates = fFitConfig.GetTemplates();
+  for(TemplateMap::const_iterator it = templates.begin(); it != templates.end(); ++it){
+    std::vector<std::string> pdfs = it->second.GetPdfs();
+    if(pdfs.empty())
+      pdfs.assign(distsToFit.begin(), distsToFit.end());
+    fTemplatePdfs[it->first] = pdfs;
+
+    const std::vector<std::string>& dirs = it->second.GetDirs();
+    for(size_t k = 0; k < dirs.size(); k++)
+      fTemplateVariants[it->first].push_back(LoadPdfs(dirs.at(k), pdfs));
+    std::cout << "Interpolating " << pdfs.size() << " pdfs between " << dirs.size() 
+              << " templates for " << it->first << std::endl;
+  }
+
+  // if its a root tree then bin it up
+  if(dataPath_.substr(dataPath_.find_last_of(".") + 1) == "h5"){
+    Histogram loaded = IO::LoadHistogram(dataPath_);
+    fDataDist = BinnedED("data", loaded);
+    fDataDist.SetObservables(fDistConfig.GetBranchNames());
+  }
+  else{
+    CutLog log(cutCol.GetCutNames());
+    fDataDist = DistBuilder::Build("data", fDistConfig, dataPath_, cutConfs, log, useCutIndex, adaptiveOrder);
+    fDataCutLog = "Cut log for data set " + dataPath_ + "\n" + log.AsString() + "\n";
+  }
+
+  //marginalise over PSD for 3D fitting
+  if(dims_ == "3d"){
+    std::cout << "Marginilising for 3d" << std::endl;
+    std::vector<std::string> keepObs;
+    keepObs.push_back("energy");
+    keepObs.push_back("r");
+    keepObs.push_back("timePSD");
+    fDataDist = fDataDist.Marginalise(keepObs);
+  }
+
+  //marginalise over PSD for 2D fitting
+  if(dims_ == "2d"){
+    std::cout << "Marginilising for 2d" << std::endl;
+    std::vector<std::string> keepObs;
+    keepObs.push_back("energy");
+    keepObs.push_back("r");
+    fDataDist = fDataDist.Marginalise(keepObs);
+  }
+
+  // factors summed down to whatever the data kept
+  for(size_t i = 0; i < fFactorised.size(); i++)
+    fFactorised[i] = fFactorised[i].Marginalise(fDataDist.GetAxes().GetAxisNames());
+
+  // fix the parameter order once, everything downstream works on arrays
+  fLayout = ParameterLayout(fFitConfig);
+}
+
+// out of line, SharedPdfStore is only forward declared in the header
+FitSetup::~FitSetup(){}
+
+void
+FitSetup::LoadDists(const std::set<std::string>& names_){
+  std::vector<BinnedED> dists = LoadPdfs(fDistConfig.GetPDFDir(), 
+                                         std::vector<std::string>(names_.begin(), names_.end()));
+  fDists.insert(fDists.end(), dists.begin(), dists.end());
+}
+
+std::vector<BinnedED>
+FitSetup::LoadPdfs(const std::string& dir_, const std::vector<std::string>& names_) const{
+  std::vector<BinnedED> dists;
+  if(fDistConfig.GetBundle()){
+    // one open, only the fitted pdfs are read
+    PdfBundle bundle(PdfBundle::BundlePath(dir_));
+    for(size_t i = 0; i < names_.size(); i++)
+      dists.push_back(bundle.Load(names_.at(i)));
+  }
+  else{
+    for(size_t i = 0; i < names_.size(); i++){
+      std::string distPath = dir_ + "/" + names_.at(i) + ".h5";
+      dists.push_back(BinnedED(names_.at(i), IO::LoadHistogram(distPath)));
+    }
+  }
+  return dists;
+}
+
+const FitConfig&
+FitSetup::GetFitConfig() const{
+  return fFitConfig;
+}
+
+const DistConfig&
+FitSetup::GetDistConfig() const{
+  return fDistConfig;
+}
+
+const ParameterLayout&
+FitSetup::GetLayout() const{
+  return fLayout;
+}
+
+std::vector<BinnedED>
+FitSetup::GetDists() const{
+  if(!fFactorised.empty()){
+    std::vector<BinnedED> dists;
+    for(size_t i = 0; i < fFactorised.size(); i++)
+      dists.push_back(fFactorised.at(i).Dense(fDataDist.GetAxes()));
+    return dists;
+  }
+  if(!fStore)
+    return fDists;
+
+  // same binning as the data, the likelihood checks that
+  const std::vector<std::string>& names = fStore->GetNames();
+  const double* probs = fStore->GetProbs();
+  std::vector<BinnedED> dists;
+  for(size_t j = 0; j < names.size(); j++){
+    std::vector<double> contents(fStore->GetNBins());
+    for(size_t i = 0; i < contents.size(); i++)
+      contents[i] = probs[i * names.size() + j];
+    BinnedED dist(names.at(j), fDataDist.GetAxes());
+    dist.SetBinContents(contents);
+    dists.push_back(dist);
+  }
+  return dists;
+}
+
+const BinnedED&
+FitSetup::GetDataDist() const{
+  return fDataDist;
+}
+
+const std::string&
+FitSetup::GetDataCutLog() const{
+  return fDataCutLog;
+}
+
+IndexedBinnedNLLH
+FitSetup::BuildLikelihood(bool constraints_) const{
+  if(fStore && fStore->GetNBins() != fDataDist.GetNBins())
+    throw DimensionError(Formatter() << "FitSetup:: shared pdfs have " << fStore->GetNBins()
+                         << " bins, data has " << fDataDist.GetNBins());
+  IndexedBinnedNLLH lh = fStore ? IndexedBinnedNLLH(fLayout, fStore->GetNames(), fStore->GetProbs(), fDataDist)
+                                : fFactorised.empty() ? IndexedBinnedNLLH(fLayout, fDists, fDataDist)
+                                                      : IndexedBinnedNLLH(fLayout, fFactorised, fDataDist);
+
+  typedef std::map<std::string, std::string> StringMap;
+  const StringMap& systTypes = fFitConfig.GetSystematicTypes();
+  const StringMap& systAxes  = fFitConfig.GetSystematicAxes();
+  const std::map<std::string, TemplateConfig>& templates = fFitConfig.GetTemplates();
+  for(StringMap::const_iterator it = systTypes.begin(); it != systTypes.end(); ++it){
+    if(it->second == "energy_scale")
+      lh.SetEnergyScale(it->first, systAxes.at(it->first));
+    else if(it->second == "energy_resolution")
+      lh.SetEnergyResolution(it->first, systAxes.at(it->first));
+    else
+      lh.SetTemplates(it->first, fTemplatePdfs.at(it->first), templates.at(it->first).GetValues(),
+                      fTemplateVariants.at(it->first), templates.at(it->first).GetExponential());
+  }
+
+  if(!fCounts.empty())
+    lh.SetMCCounts(fCountNames, fCounts);
+  if(!constraints_)
+    return lh;
+
+  const ParameterDict& constrMeans  = fFitConfig.GetConstrMeans();
+  const ParameterDict& constrSigmas = fFitConfig.GetConstrSigmas();
+  for(ParameterDict::const_iterator it = constrMeans.begin(); it != constrMeans.end();
+      ++it)
+    lh.SetConstraint(it->first, it->second, constrSigmas.at(it->first));
+  return lh;
+}
+
+}
@@ -0,0 +1,69 @@
+#ifndef __BBFIT__FitSetup__
+#define __BBFIT__FitSetup__
+#include <FitConfig.hh>
+#include <DistConfig.hh>
+#include <ParameterLayout.hh>
+#include <IndexedBinnedNLLH.hh>
+#include <BinnedED.h>
+#include <FactorisedPdf.hh>
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <memory>
+
+// Loads everything a fit needs from the fit/dist/cut configs and the data set,
+// so that fit_dataset and the other fitting executables build exactly the 
+// same likelihood
+
+namespace bbfit{
+class SharedPdfStore;
+
+class FitSetup{
+public:
+  FitSetup(const std::string& fitConfigFile_, const std::string& distConfigFile_,
+           const std::string& cutConfigFile_, const std::string& dataPath_,
+           const std::string& dims_, bool sharePdfs_ = false);
+  ~FitSetup();
+
+  const FitConfig&  GetFitConfig() const;
+  const DistConfig& GetDistConfig() const;
+  const ParameterLayout& GetLayout() const;
+
+  // copies, rebuilt from the shared matrix or the factors if need be
+  std::vector<BinnedED> GetDists() const;
+  const BinnedED& GetDataDist() const;
+
+  // empty if the data was already binned
+  const std::string& GetDataCutLog() const;
+
+  // binned -log(lh) on the loaded pdfs and data, with the configured constraints
+  // unless whoever combines it applies them
+  IndexedBinnedNLLH BuildLikelihood(bool constraints_ = true) const;
+
+private:
+  FitSetup(const FitSetup&);
+  FitSetup& operator=(const FitSetup&);
+
+  void LoadDists(const std::set<std::string>& names_);
+  std::vector<BinnedED> LoadPdfs(const std::string& dir_, const std::vector<std::string>& names_) const;
+
+  FitConfig  fFitConfig;
+  DistConfig fDistConfig;
+  ParameterLayout fLayout;
+  std::vector<BinnedED> fDists;
+  BinnedED    fDataDist;
+  std::string fDataCutLog;
+  std::unique_ptr<SharedPdfStore> fStore; // empty unless the pdfs are shared, then fDists is empty
+  std::vector<FactorisedPdf> fFactorised; // instead of fDists if the pdfs are factorised
+
+  // for each template parameter, the pdfs it moves and those pdfs at each grid point
+  std::map<std::string, std::vector<std::string> > fTemplatePdfs;
+  std::map<std::string, std::vector<std::vector<BinnedED> > > fTemplateVariants;
+
+  // the raw MC counts make_pdfs saved, if the fit wants them
+  std::vector<std::string> fCountNames;
+  std::vector<BinnedED>    fCounts;
+};
+}
+#endif
@@ -0,0 +1,511 @@
+#include <IndexedBinnedNLLH.hh>
+#include <BinnedED.h>
+#include <FactorisedPdf.hh>
+#include <Exceptions.h>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+namespace bbfit{
+
+IndexedBinnedNLLH::IndexedBinnedNLLH(const ParameterLayout& layout_, 
+                                     const std::vector<BinnedED>& pdfs_,
+                                     const BinnedED& data_) : fLayout(layout_), fExternalProbs(NULL),
+                                                        fScaleParam(-1), fResolutionParam(-1){
+  fNBins = data_.GetNBins();
+  fData  = data_.GetBinContents();
+  fAxes  = data_.GetAxes();
+  fProbs = BuildProbs(pdfs_, fNBins);
+  for(size_t j = 0; j < pdfs_.size(); j++)
+    fPdfParams.push_back(fLayout.GetIndex(pdfs_.at(j).GetName()));
+  IndexBins();
+}
+
+IndexedBinnedNLLH::IndexedBinnedNLLH(const ParameterLayout& layout_, 
+                                     const std::vector<std::string>& pdfNames_,
+                                     const double* probs_,
+                                     const BinnedED& data_) : fLayout(layout_), fExternalProbs(probs_),
+                                                        fScaleParam(-1), fResolutionParam(-1){
+  fNBins = data_.GetNBins();
+  fData  = data_.GetBinContents();
+  fAxes  = data_.GetAxes();
+  for(size_t j = 0; j < pdfNames_.size(); j++)
+    fPdfParams.push_back(fLayout.GetIndex(pdfNames_.at(j)));
+  IndexBins();
+}
+
+IndexedBinnedNLLH::IndexedBinnedNLLH(const ParameterLayout& layout_, 
+                                     const std::vector<FactorisedPdf>& pdfs_,
+                                     const BinnedED& data_) : fLayout(layout_), fExternalProbs(NULL),
+                                                        fScaleParam(-1), fResolutionParam(-1){
+  fNBins = data_.GetNBins();
+  fData  = data_.GetBinContents();
+  fAxes  = data_.GetAxes();
+  if(pdfs_.empty()){
+    IndexBins();
+    return;
+  }
+
+  // the bin mapping is shared, so the factors must be laid out the same way
+  const FactorisedPdf& first = pdfs_.at(0);
+  first.MapBins(data_.GetAxes(), fMarginalBins, fConditionalBins);
+
+  size_t nPdfs = pdfs_.size();
+  size_t nMarg = first.GetMarginal().GetNBins();
+  size_t nCond = first.GetConditional().GetNBins();
+  fMarginals.resize(nMarg * nPdfs);
+  fConditionals.resize(nCond * nPdfs);
+  for(size_t j = 0; j < nPdfs; j++){
+    const FactorisedPdf& pdf = pdfs_.at(j);
+    if(pdf.GetMarginal().GetAxisNames() != first.GetMarginal().GetAxisNames() ||
+       pdf.GetConditional().GetAxisNames() != first.GetConditional().GetAxisNames() ||
+       pdf.GetMarginal().GetNBins() != nMarg || pdf.GetConditional().GetNBins() != nCond)
+      throw DimensionError("IndexedBinnedNLLH::factorised pdf " + pdf.GetName() 
+                           + " isn't factorised the same way as " + first.GetName());
+
+    fPdfParams.push_back(fLayout.GetIndex(pdf.GetName()));
+    for(size_t i = 0; i < nMarg; i++)
+      fMarginals[i * nPdfs + j] = pdf.GetMarginal().GetBinContent(i);
+    for(size_t i = 0; i < nCond; i++)
+      fConditionals[i * nPdfs + j] = pdf.GetConditional().GetBinContent(i);
+  }
+  IndexBins();
+}
+
+std::vector<double>
+IndexedBinnedNLLH::BuildProbs(const std::vector<BinnedED>& pdfs_, size_t nBins_){
+  size_t nPdfs = pdfs_.size();
+  std::vector<double> probs(nBins_ * nPdfs);
+  for(size_t j = 0; j < nPdfs; j++){
+    const BinnedED& pdf = pdfs_.at(j);
+    if(pdf.GetNBins() != nBins_)
+      throw DimensionError(Formatter() << "IndexedBinnedNLLH::pdf " << pdf.GetName()
+                           << " has " << pdf.GetNBins() << " bins, data has " << nBins_);
+    
+    std::vector<double> contents = pdf.GetBinContents();
+    double integral = pdf.Integral();
+    double norm = integral ? 1./integral : 0;
+    for(size_t i = 0; i < nBins_; i++)
+      probs[i * nPdfs + j] = contents.at(i) * norm;
+  }
+  return probs;
+}
+
+const double*
+IndexedBinnedNLLH::Probs() const{
+  // not cached, copies of the likelihood must not point at each other's fProbs
+  if(fExternalProbs)
+    return fExternalProbs;
+  return fProbs.empty() ? NULL : &fProbs[0];
+}
+
+const double*
+IndexedBinnedNLLH::Probs(const double* params_, const double*& totals_, ShapeHolder& holder_) const{
+  const double* probs = Probs();
+  totals_ = fPdfTotals.empty() ? NULL : &fPdfTotals[0];
+  std::vector<double> inputKey;
+  if(fTemplates){
+    holder_.fTemplates = fTemplates->Apply(probs, params_);
+    probs   = &holder_.fTemplates->fProbs[0];
+    totals_ = &holder_.fTemplates->fTotals[0];
+    inputKey = holder_.fTemplates->fKey;
+  }
+  if(fMorph){
+    holder_.fMorphed = fMorph->Apply(probs, fPdfParams.size(),
+                                     fScaleParam < 0 ? 1 : params_[fScaleParam],
+                                     fResolutionParam < 0 ? 0 : params_[fResolutionParam],
+                                     inputKey);
+    probs   = &holder_.fMorphed->fProbs[0];
+    totals_ = &holder_.fMorphed->fTotals[0];
+  }
+  return probs;
+}
+
+inline const double*
+IndexedBinnedNLLH::Row(const double* probs_, size_t bin_, double* buffer_) const{
+  // every pdf's probability in bin_, dense ones point straight into the matrix
+  size_t nPdfs = fPdfParams.size();
+  if(fMarginalBins.empty())
+    return probs_ + bin_ * nPdfs;
+
+  const double* f = &fMarginals[fMarginalBins[bin_] * nPdfs];
+  const double* g = &fConditionals[fConditionalBins[bin_] * nPdfs];
+  for(size_t j = 0; j < nPdfs; j++)
+    buffer_[j] = f[j] * g[j];
+  return buffer_;
+}
+
+void
+IndexedBinnedNLLH::IndexBins(){
+  // one pass over everything, the evaluations only touch fOccupied after this
+  size_t nPdfs = fPdfParams.size();
+  std::vector<double> buffer(nPdfs);
+  fPdfTotals.assign(nPdfs, 0);
+  fOccupied.clear();
+  const double* probs = Probs();
+  for(size_t i = 0; i < fNBins; i++){
+    const double* row = Row(probs, i, &buffer[0]);
+    for(size_t j = 0; j < nPdfs; j++)
+      fPdfTotals[j] += row[j];
+    if(fData[i])
+      fOccupied.push_back(i);
+  }
+}
+
+void
+IndexedBinnedNLLH::AddMorph(const std::string& axis_){
+  if(!fMarginalBins.empty())
+    throw ValueError("IndexedBinnedNLLH:: energy systematics need dense pdfs, not factorised ones");
+  if(!fMorph)
+    fMorph.reset(new EnergyMorph(fAxes, axis_));
+  else if(fMorph->GetAxisName() != axis_)
+    throw ValueError("IndexedBinnedNLLH:: energy scale and resolution must act on the same axis, got "
+                     + fMorph->GetAxisName() + " and " + axis_);
+}
+
+void
+IndexedBinnedNLLH::SetEnergyScale(const std::string& param_, const std::string& axis_){
+  // the morph can't scale by <= 0, better to hear now than mid fit
+  size_t param = fLayout.GetIndex(param_);
+  if(!(fLayout.GetMinima().at(param) > 0))
+    throw ValueError(Formatter() << "IndexedBinnedNLLH::Energy scale " << param_ << " must stay above 0, its min is "
+                     << fLayout.GetMinima().at(param));
+  AddMorph(axis_);
+  fScaleParam = param;
+  fShapeParams.push_back(fScaleParam);
+}
+
+void
+IndexedBinnedNLLH::SetEnergyResolution(const std::string& param_, const std::string& axis_){
+  AddMorph(axis_);
+  fResolutionParam = fLayout.GetIndex(param_);
+  fShapeParams.push_back(fResolutionParam);
+}
+
+void
+IndexedBinnedNLLH::SetTemplates(const std::string& param_, const std::vector<std::string>& pdfs_,
+                                const std::vector<double>& values_,
+                                const std::vector<std::vector<BinnedED> >& variants_,
+                                bool exponential_){
+  if(!fMarginalBins.empty())
+    throw ValueError("IndexedBinnedNLLH:: template interpolation needs dense pdfs, not factorised ones");
+
+  std::vector<size_t> columns;
+  for(size_t c = 0; c < pdfs_.size(); c++){
+    size_t param = fLayout.GetIndex(pdfs_.at(c));
+    size_t col = std::find(fPdfParams.begin(), fPdfParams.end(), param) - fPdfParams.begin();
+    if(col == fPdfParams.size())
+      throw NotFoundError("IndexedBinnedNLLH:: can't interpolate " + pdfs_.at(c) + ", it isn't in the fit");
+    columns.push_back(col);
+  }
+
+  std::vector<std::vector<double> > matrices;
+  for(size_t k = 0; k < variants_.size(); k++)
+    matrices.push_back(BuildProbs(variants_.at(k), fNBins));
+
+  if(!fTemplates)
+    fTemplates.reset(new TemplateMorph(fNBins, fPdfParams.size()));
+  fTemplates->AddParameter(fLayout.GetIndex(param_), columns, values_, matrices, exponential_);
+  fShapeParams.push_back(fLayout.GetIndex(param_));
+}
+
+void
+IndexedBinnedNLLH::SetMCCounts(const std::vector<std::string>& pdfs_, const std::vector<BinnedED>& counts_){
+  size_t nPdfs = fPdfParams.size();
+  fInvCounts.assign(fNBins * nPdfs, 0);
+  for(size_t c = 0; c < pdfs_.size(); c++){
+    size_t param = fLayout.GetIndex(pdfs_.at(c));
+    size_t col = std::find(fPdfParams.begin(), fPdfParams.end(), param) - fPdfParams.begin();
+    if(col == nPdfs)
+      throw NotFoundError("IndexedBinnedNLLH:: have MC counts for " + pdfs_.at(c) + ", but it isn't in the fit");
+
+    const BinnedED& counts = counts_.at(c);
+    if(counts.GetNBins() != fNBins)
+      throw DimensionError(Formatter() << "IndexedBinnedNLLH::MC counts for " << pdfs_.at(c)
+                           << " have " << counts.GetNBins() << " bins, data has " << fNBins);
+    for(size_t i = 0; i < fNBins; i++){
+      double m = counts.GetBinContent(i);
+      fInvCounts[i * nPdfs + col] = m > 0 ? 1./m : 0;
+    }
+  }
+}
+
+void
+IndexedBinnedNLLH::SetConstraint(const std::string& name_, double mean_, double sigma_){
+  fConstrParams.push_back(fLayout.GetIndex(name_));
+  fConstrMeans.push_back(mean_);
+  fConstrSigmas.push_back(sigma_);
+}
+
+size_t
+IndexedBinnedNLLH::GetNParams() const{
+  return fLayout.GetNParams();
+}
+
+size_t
+IndexedBinnedNLLH::GetNBins() const{
+  return fNBins;
+}
+
+size_t
+IndexedBinnedNLLH::GetNPdfs() const{
+  return fPdfParams.size();
+}
+
+size_t
+IndexedBinnedNLLH::GetNOccupiedBins() const{
+  return fOccupied.size();
+}
+
+double
+IndexedBinnedNLLH::ConstraintTerm(const double* params_, double* grad_) const{
+  double sum = 0;
+  for(size_t i = 0; i < fConstrParams.size(); i++){
+    double pull = (params_[fConstrParams[i]] - fConstrMeans[i])/fConstrSigmas[i];
+    sum += 0.5 * pull * pull;
+    if(grad_)
+      grad_[fConstrParams[i]] += pull/fConstrSigmas[i];
+  }
+  return sum;
+}
+
+std::vector<double>
+IndexedBinnedNLLH::ExpectedCounts(const double* params_) const{
+  size_t nPdfs = fPdfParams.size();
+  std::vector<double> buffer(nPdfs);
+  std::vector<double> norms(nPdfs);
+  for(size_t j = 0; j < nPdfs; j++)
+    norms[j] = params_[fPdfParams[j]];
+
+  const double* totals;
+  ShapeHolder holder;
+  const double* probs = Probs(params_, totals, holder);
+
+  std::vector<double> expected(fNBins, 0);
+  for(size_t i = 0; i < fNBins; i++){
+    const double* row = Row(probs, i, &buffer[0]);
+    double nu = 0;
+    for(size_t j = 0; j < nPdfs; j++)
+      nu += norms[j] * row[j];
+    expected[i] = nu;
+  }
+  return expected;
+}
+
+double
+IndexedBinnedNLLH::PoissonTerm(const double* params_, double* pdfGrad_) const{
+  if(!fInvCounts.empty())
+    return BarlowBeestonTerm(params_, pdfGrad_);
+
+  size_t nPdfs = fPdfParams.size();
+  std::vector<double> buffer(nPdfs);
+  std::vector<double> norms(nPdfs);
+  for(size_t j = 0; j < nPdfs; j++)
+    norms[j] = params_[fPdfParams[j]];
+
+  const double* totals;
+  ShapeHolder holder;
+  const double* probs = Probs(params_, totals, holder);
+  
+  // sum_i nu_i = sum_j n_j sum_i p_ij
+  // d/dn_j (nu - d log nu) = p_ij (1 - d/nu), the 1s summed up front
+  double nllh = 0;
+  for(size_t j = 0; j < nPdfs; j++){
+    nllh += norms[j] * totals[j];
+    if(pdfGrad_)
+      pdfGrad_[j] = totals[j];
+  }
+
+  for(size_t o = 0; o < fOccupied.size(); o++){
+    size_t i = fOccupied[o];
+    const double* row = Row(probs, i, &buffer[0]);
+    double nu = 0;
+    for(size_t j = 0; j < nPdfs; j++)
+      nu += norms[j] * row[j];
+
+    if(nu <= 0)
+      return std::numeric_limits<double>::infinity();
+    nllh -= fData[i] * log(nu);
+    if(!pdfGrad_)
+      continue;
+    double factor = fData[i]/nu;
+    for(size_t j = 0; j < nPdfs; j++)
+      pdfGrad_[j] -= factor * row[j];
+  }
+  return nllh;
+}
+
+double
+IndexedBinnedNLLH::BarlowBeestonTerm(const double* params_, double* pdfGrad_) const{
+  // nu_i -> beta_i nu_i with a gaussian constraint on beta_i of relative width
+  // sqrt(r_i), r_i = s2_i/nu_i^2, s2_i = sum_j (n_j p_ij)^2/m_ij. beta_i solves a 
+  // quadratic, and at that beta the derivative wrt beta vanishes, so the 
+  // gradient is the partial derivative at fixed beta
+  size_t nPdfs = fPdfParams.size();
+  std::vector<double> buffer(nPdfs);
+  std::vector<double> norms(nPdfs);
+  for(size_t j = 0; j < nPdfs; j++){
+    norms[j] = params_[fPdfParams[j]];
+    if(pdfGrad_)
+      pdfGrad_[j] = 0;
+  }
+
+  const double* totals;
+  ShapeHolder holder;
+  const double* probs = Probs(params_, totals, holder);
+
+  // every bin with a prediction counts, empty data or not
+  double nllh = 0;
+  for(size_t i = 0; i < fNBins; i++){
+    const double* row = Row(probs, i, &buffer[0]);
+    const double* invCounts = &fInvCounts[i * nPdfs];
+    double nu = 0;
+    double s2 = 0;
+    for(size_t j = 0; j < nPdfs; j++){
+      double nuj = norms[j] * row[j];
+      nu += nuj;
+      s2 += nuj * nuj * invCounts[j];
+    }
+    double d = fData[i];
+    if(nu <= 0){
+      if(d)
+        return std::numeric_limits<double>::infinity();
+      continue;
+    }
+
+    if(!s2){
+      nllh += nu;
+      if(d)
+        nllh -= d * log(nu);
+      if(pdfGrad_)
+        for(size_t j = 0; j < nPdfs; j++)
+          pdfGrad_[j] += (1 - d/nu) * row[j];
+      continue;
+    }
+
+    // beta^2 + b beta - d r = 0, b = nu r - 1, positive root
+    double r = s2/(nu * nu);
+    double b = nu * r - 1;
+    double disc = sqrt(b * b + 4 * d * r);
+    double beta = b > 0 ? 2 * d * r/(b + disc) : 0.5 * (disc - b);
+
+    // (beta - 1)^2/2r = (beta - 1)^2 nu^2/2 s2
+    double penalty = 0.5 * (beta - 1) * (beta - 1);
+    nllh += beta * nu + penalty * nu * nu/s2;
+    if(d)
+      nllh -= d * log(beta * nu);
+
+    if(!pdfGrad_)
+      continue;
+    for(size_t j = 0; j < nPdfs; j++){
+      double dS2 = 2 * norms[j] * row[j] * row[j] * invCounts[j];
+      pdfGrad_[j] += (beta - d/nu) * row[j] 
+                     + penalty * (2 * nu * row[j]/s2 - nu * nu * dS2/(s2 * s2));
+    }
+  }
+  return nllh;
+}
+
+double
+IndexedBinnedNLLH::Evaluate(const double* params_) const{
+  return PoissonTerm(params_, NULL) + ConstraintTerm(params_, NULL);
+}
+
+double
+IndexedBinnedNLLH::EvaluateGradient(const double* params_, double* grad_) const{
+  size_t nPdfs = fPdfParams.size();
+  std::vector<double> pdfGrad(nPdfs, 0);
+  double nllh = PoissonTerm(params_, &pdfGrad[0]);
+
+  // zero even if there's no gradient to be had, the caller's buffer holds 
+  // the last point's otherwise
+  for(size_t k = 0; k < GetNParams(); k++)
+    grad_[k] = 0;
+  if(std::isinf(nllh))
+    return nllh;
+
+  for(size_t j = 0; j < nPdfs; j++)
+    grad_[fPdfParams[j]] += pdfGrad[j];
+
+  // the shape parameters move every bin, central differences like IndexedLikelihood.
+  // Kept inside the box, past it a resolution of 0 is the identity and 
+  // templates stop at the ends of their grid, so the far side is wrong
+  std::vector<double> shifted(params_, params_ + GetNParams());
+  for(size_t n = 0; n < fShapeParams.size(); n++){
+    size_t k = fShapeParams[n];
+    double h = 1e-5 * std::max(std::abs(params_[k]), 1.);
+    double down, up;
+    Stencil(params_[k], h, fLayout.GetMinima()[k], fLayout.GetMaxima()[k], down, up);
+    if(up <= down)
+      continue;
+    shifted[k] = up;
+    double nllhUp = PoissonTerm(&shifted[0], NULL);
+    shifted[k] = down;
+    double nllhDown = PoissonTerm(&shifted[0], NULL);
+    shifted[k] = params_[k];
+    grad_[k] += (nllhUp - nllhDown)/(up - down);
+  }
+
+  return nllh + ConstraintTerm(params_, grad_);
+}
+
+void
+IndexedBinnedNLLH::GetBounds(std::vector<double>& minima_, std::vector<double>& maxima_) const{
+  minima_ = fLayout.GetMinima();
+  maxima_ = fLayout.GetMaxima();
+}
+
+void
+IndexedBinnedNLLH::EvaluateHessian(const double* params_, std::vector<double>& hess_) const{
+  // with shape parameters or the MC stat term it isn't this simple, 
+  // differentiate the gradient
+  if(!fShapeParams.empty() || !fInvCounts.empty()){
+    IndexedLikelihood::EvaluateHessian(params_, hess_);
+    return;
+  }
+
+  size_t nParams = GetNParams();
+  size_t nPdfs = fPdfParams.size();
+  std::vector<double> buffer(nPdfs);
+  std::vector<double> norms(nPdfs);
+  for(size_t j = 0; j < nPdfs; j++)
+    norms[j] = params_[fPdfParams[j]];
+
+  // d2/dn_j dn_k (nu - d log nu) = d p_ij p_ik / nu^2
+  std::vector<double> pdfHess(nPdfs * nPdfs, 0);
+  for(size_t o = 0; o < fOccupied.size(); o++){
+    size_t i = fOccupied[o];
+    const double* row = Row(Probs(), i, &buffer[0]);
+    double nu = 0;
+    for(size_t j = 0; j < nPdfs; j++)
+      nu += norms[j] * row[j];
+    if(nu <= 0)
+      continue;
+
+    double weight = fData[i]/(nu * nu);
+    for(size_t j = 0; j < nPdfs; j++){
+      if(!row[j])
+        continue;
+      double wj = weight * row[j];
+      for(size_t k = j; k < nPdfs; k++)
+        pdfHess[j * nPdfs + k] += wj * row[k];
+    }
+  }
+
+  hess_.assign(nParams * nParams, 0);
+  for(size_t j = 0; j < nPdfs; j++)
+    for(size_t k = j; k < nPdfs; k++){
+      size_t pj = fPdfParams[j];
+      size_t pk = fPdfParams[k];
+      hess_[pj * nParams + pk] += pdfHess[j * nPdfs + k];
+      if(pj != pk)
+        hess_[pk * nParams + pj] += pdfHess[j * nPdfs + k];
+    }
+
+  for(size_t i = 0; i < fConstrParams.size(); i++){
+    size_t p = fConstrParams[i];
+    hess_[p * nParams + p] += 1/(fConstrSigmas[i] * fConstrSigmas[i]);
+  }
+}
+
+}
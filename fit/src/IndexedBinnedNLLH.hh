@@ -0,0 +1,127 @@
+#ifndef __BBFIT__IndexedBinnedNLLH__
+#define __BBFIT__IndexedBinnedNLLH__
+#include <IndexedLikelihood.hh>
+#include <ParameterLayout.hh>
+#include <EnergyMorph.hh>
+#include <TemplateMorph.hh>
+#include <AxisCollection.h>
+#include <vector>
+#include <string>
+#include <memory>
+
+class BinnedED;
+
+// Extended binned poisson -log(lh), same test statistic as oxsx BinnedNLLH 
+// plus gaussian constraints. The pdfs are copied once into a bin-major matrix 
+// and each one is scaled by the parameter of the same name. Factorised pdfs 
+// keep their two factors instead, and the product is taken bin by bin.
+// sum_i nu_i is linear in the normalisations, so it is taken from per pdf 
+// totals and only bins with data are visited on each evaluation. Energy 
+// scale/resolution parameters morph the dense matrix through an EnergyMorph,
+// after any template parameters have interpolated their pdfs (TemplateMorph).
+// With MC counts set, each bin gets a Barlow-Beeston-lite nuisance that is 
+// solved for in closed form, and then every bin with a prediction is visited
+
+namespace bbfit{
+class FactorisedPdf;
+
+class IndexedBinnedNLLH : public IndexedLikelihood{
+public:
+  IndexedBinnedNLLH(const ParameterLayout& layout_, 
+                    const std::vector<BinnedED>& pdfs_, 
+                    const BinnedED& data_);
+
+  // pdfs already normalised into a bin-major matrix owned by someone else 
+  // (e.g. a SharedPdfStore), which must outlive the likelihood
+  IndexedBinnedNLLH(const ParameterLayout& layout_, 
+                    const std::vector<std::string>& pdfNames_,
+                    const double* probs_,
+                    const BinnedED& data_);
+
+  // all with the same factor axes
+  IndexedBinnedNLLH(const ParameterLayout& layout_, 
+                    const std::vector<FactorisedPdf>& pdfs_,
+                    const BinnedED& data_);
+
+  // the matrix the first constructor builds: column j is pdf j normalised to 1
+  static std::vector<double> BuildProbs(const std::vector<BinnedED>& pdfs_, size_t nBins_);
+
+  void SetConstraint(const std::string& name_, double mean_, double sigma_);
+
+  // the unnormalised MC counts behind the named pdfs, switches on the MC 
+  // statistical uncertainty. Pdfs left out are taken as exact
+  void SetMCCounts(const std::vector<std::string>& pdfs_, const std::vector<BinnedED>& counts_);
+
+  // param_ stretches every pdf along axis_, E -> param E, nominal 1
+  void SetEnergyScale(const std::string& param_, const std::string& axis_);
+  // param_ smears every pdf along axis_ by a gaussian of width param sqrt(E), 
+  // nominal 0. Must be the same axis as the scale
+  void SetEnergyResolution(const std::string& param_, const std::string& axis_);
+
+  // param_ interpolates the pdfs named pdfs_ between templates: variants_[k] 
+  // holds them, in the same order, as built at values_[k]
+  void SetTemplates(const std::string& param_, const std::vector<std::string>& pdfs_,
+                    const std::vector<double>& values_,
+                    const std::vector<std::vector<BinnedED> >& variants_,
+                    bool exponential_);
+
+  size_t GetNParams() const;
+  double Evaluate(const double* params_) const;
+  double EvaluateGradient(const double* params_, double* grad_) const;
+  void   EvaluateHessian(const double* params_, std::vector<double>& hess_) const;
+  void   GetBounds(std::vector<double>& minima_, std::vector<double>& maxima_) const;
+
+  size_t GetNBins() const;
+  size_t GetNPdfs() const;
+  size_t GetNOccupiedBins() const;
+
+  // expected counts in every bin at params_
+  std::vector<double> ExpectedCounts(const double* params_) const;
+  
+private:
+  // keeps whatever matrices an evaluation is using alive until it's done
+  struct ShapeHolder{
+    std::shared_ptr<const TemplateMorph::Interpolated> fTemplates;
+    std::shared_ptr<const EnergyMorph::Morphed>        fMorphed;
+  };
+
+  double ConstraintTerm(const double* params_, double* grad_) const;
+  // -log(lh) without the constraints, pdfGrad_ (if not NULL) gets d/dn_j for each pdf
+  double PoissonTerm(const double* params_, double* pdfGrad_) const;
+  double BarlowBeestonTerm(const double* params_, double* pdfGrad_) const;
+  const double* Probs() const;
+  const double* Probs(const double* params_, const double*& totals_, ShapeHolder& holder_) const;
+  const double* Row(const double* probs_, size_t bin_, double* buffer_) const;
+  void IndexBins();
+  void AddMorph(const std::string& axis_);
+
+  ParameterLayout     fLayout;
+  size_t              fNBins;
+  std::vector<size_t> fPdfParams; // parameter index for each pdf
+  std::vector<double> fProbs;     // fNBins x nPdfs, bin major
+  const double*       fExternalProbs; // used instead of fProbs if set
+
+  // factorised pdfs: p_ij = f[fMarginalBins[i]][j] * g[fConditionalBins[i]][j]
+  std::vector<double>   fMarginals;    // bin major, like fProbs
+  std::vector<double>   fConditionals;
+  std::vector<unsigned> fMarginalBins; // empty unless factorised
+  std::vector<unsigned> fConditionalBins;
+  std::vector<double> fData;
+  AxisCollection      fAxes;
+  std::vector<unsigned> fOccupied;   // bins with data
+  std::vector<double>   fPdfTotals;  // sum over all bins of each column
+  std::vector<double>   fInvCounts;  // 1/MC counts like fProbs, empty unless set
+
+  // copies share the morphs, their caches don't depend on which copy asks
+  std::shared_ptr<TemplateMorph> fTemplates;
+  std::shared_ptr<EnergyMorph> fMorph;
+  long fScaleParam;      // -1 if not floated
+  long fResolutionParam;
+  std::vector<size_t> fShapeParams; // everything that changes the pdf shapes
+
+  std::vector<size_t> fConstrParams;
+  std::vector<double> fConstrMeans;
+  std::vector<double> fConstrSigmas;
+};
+}
+#endif
@@ -0,0 +1,396 @@
+#include <IndexedHMC.hh>
+#include <IndexedLikelihood.hh>
+#include <Histogram.h>
+#include <AxisCollection.h>
+#include <BinAxis.h>
+#include <Rand.h>
+#include <Exceptions.h>
+#include <iostream>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+namespace bbfit{
+
+IndexedHMC::IndexedHMC(const IndexedLikelihood& lh_, const ParameterLayout& layout_,
+                       double epsilon_, int nSteps_) 
+  : fLH(lh_), fLayout(layout_), fEpsilon(epsilon_), fNSteps(nSteps_), 
+    fMaxIter(0), fBurnIn(0), fBurnInWindow(0), fBurnInSkip(0), fBurnInUsed(0), fBestFitNLLH(std::numeric_limits<double>::infinity()),
+    fAccepted(0), fTried(0){
+  if(fLH.GetNParams() != fLayout.GetNParams())
+    throw DimensionError(Formatter() << "IndexedHMC::likelihood has " << fLH.GetNParams()
+                         << " parameters, layout has " << fLayout.GetNParams());
+
+  const std::vector<double>& sigmas = fLayout.GetSigmas();
+  for(size_t i = 0; i < sigmas.size(); i++)
+    fMasses.push_back(1/sigmas.at(i)/sigmas.at(i));
+}
+
+void
+IndexedHMC::SetMasses(const std::vector<double>& masses_){
+  if(masses_.size() != fLayout.GetNParams())
+    throw DimensionError("IndexedHMC::Need one mass per parameter");
+  fMasses = masses_;
+}
+
+void
+IndexedHMC::SetInitialPoint(const std::vector<double>& x_){
+  if(x_.size() != fLayout.GetNParams())
+    throw DimensionError("IndexedHMC::Initial point has the wrong number of parameters");
+  fInitialPoint = x_;
+}
+
+void
+IndexedHMC::SetMaxIter(int n_){
+  fMaxIter = n_;
+}
+
+void
+IndexedHMC::SetBurnIn(int n_){
+  fBurnIn = n_;
+}
+
+void
+IndexedHMC::SetAutoBurnIn(int window_, int skipWindows_){
+  fBurnInWindow = window_;
+  fBurnInSkip = skipWindows_;
+}
+
+int
+IndexedHMC::GetBurnInUsed() const{
+  return fBurnInUsed;
+}
+
+const std::vector<double>&
+IndexedHMC::GetBestFit() const{
+  return fBestFit;
+}
+
+double
+IndexedHMC::GetBestFitNLLH() const{
+  return fBestFitNLLH;
+}
+
+double
+IndexedHMC::GetAcceptanceRate() const{
+  return fTried ? double(fAccepted)/fTried : 0;
+}
+
+void
+IndexedHMC::Reflect(std::vector<double>& x_, std::vector<double>& p_) const{
+  const std::vector<double>& minima = fLayout.GetMinima();
+  const std::vector<double>& maxima = fLayout.GetMaxima();
+  for(size_t i = 0; i < x_.size(); i++){
+    double width = maxima[i] - minima[i];
+    // bounce off the walls until inside, a huge step is just folded back in
+    for(int nBounce = 0; (x_[i] < minima[i] || x_[i] > maxima[i]) && nBounce < 100; nBounce++){
+      if(x_[i] < minima[i])
+        x_[i] = 2 * minima[i] - x_[i];
+      else
+        x_[i] = 2 * maxima[i] - x_[i];
+      p_[i] = -p_[i];
+    }
+    if(x_[i] < minima[i] || x_[i] > maxima[i])
+      x_[i] = minima[i] + Rand::Uniform(width);
+  }
+}
+
+bool
+IndexedHMC::Step(std::vector<double>& x_, double& nllh_, std::vector<double>& grad_){
+  size_t nParams = x_.size();
+  std::vector<double> p(nParams);
+  double kinetic = 0;
+  for(size_t i = 0; i < nParams; i++){
+    p[i] = Rand::Gaus(0, sqrt(fMasses[i]));
+    kinetic += 0.5 * p[i] * p[i]/fMasses[i];
+  }
+
+  std::vector<double> x = x_;
+  std::vector<double> grad = grad_;
+  double nllh = nllh_;
+  for(int step = 0; step < fNSteps; step++){
+    for(size_t i = 0; i < nParams; i++){
+      p[i] -= 0.5 * fEpsilon * grad[i];
+      x[i] += fEpsilon * p[i]/fMasses[i];
+    }
+    Reflect(x, p);
+
+    nllh = fLH.EvaluateGradient(&x[0], &grad[0]);
+    if(!std::isfinite(nllh))
+      return false;
+
+    for(size_t i = 0; i < nParams; i++)
+      p[i] -= 0.5 * fEpsilon * grad[i];
+  }
+
+  double newKinetic = 0;
+  for(size_t i = 0; i < nParams; i++)
+    newKinetic += 0.5 * p[i] * p[i]/fMasses[i];
+
+  double logAccept = (nllh_ + kinetic) - (nllh + newKinetic);
+  if(logAccept < 0 && log(Rand::Uniform()) > logAccept)
+    return false;
+
+  x_ = x;
+  nllh_ = nllh;
+  grad_ = grad;
+  return true;
+}
+
+int
+IndexedHMC::FindBin(size_t param_, double val_) const{
+  double min = fLayout.GetMinima()[param_];
+  double max = fLayout.GetMaxima()[param_];
+  int nBins = fLayout.GetNBins()[param_];
+  if(val_ < min || val_ >= max)
+    return -1;
+  return std::min(int((val_ - min)/(max - min) * nBins), nBins - 1);
+}
+
+void
+IndexedHMC::Record(const std::vector<double>& x_, double nllh_){
+  size_t nParams = x_.size();
+  std::vector<int> bins(nParams);
+  for(size_t i = 0; i < nParams; i++){
+    bins[i] = FindBin(i, x_[i]);
+    if(bins[i] >= 0)
+      f1DCounts[i][bins[i]]++;
+  }
+
+  size_t pair = 0;
+  for(size_t i = 0; i < nParams; i++)
+    for(size_t j = i + 1; j < nParams; j++, pair++)
+      if(bins[i] >= 0 && bins[j] >= 0)
+        f2DCounts[pair][bins[i] * fLayout.GetNBins()[j] + bins[j]]++;
+
+  fNLLHChain.push_back(nllh_);
+
+  // running mean and covariance, one pass and no cancellation
+  double n = fNLLHChain.size();
+  std::vector<double> before(nParams);
+  for(size_t i = 0; i < nParams; i++){
+    before[i] = x_[i] - fSampleMeans[i];
+    fSampleMeans[i] += before[i]/n;
+  }
+  for(size_t i = 0; i < nParams; i++)
+    for(size_t j = 0; j < nParams; j++)
+      fSampleSquares[i * nParams + j] += before[i] * (x_[j] - fSampleMeans[j]);
+}
+
+void
+IndexedHMC::WindowStats(const std::vector<double>& nllhs_, double& mean_, double& error_, 
+                        double& nEff_) const{
+  double n = nllhs_.size();
+  mean_ = 0;
+  for(size_t i = 0; i < nllhs_.size(); i++)
+    mean_ += nllhs_[i];
+  mean_ /= n;
+
+  double var = 0;
+  double lag1 = 0;
+  for(size_t i = 0; i < nllhs_.size(); i++){
+    var += (nllhs_[i] - mean_) * (nllhs_[i] - mean_);
+    if(i + 1 < nllhs_.size())
+      lag1 += (nllhs_[i] - mean_) * (nllhs_[i + 1] - mean_);
+  }
+
+  // a window that never moved says nothing
+  if(!var){
+    error_ = std::numeric_limits<double>::infinity();
+    nEff_ = 1;
+    return;
+  }
+
+  // samples are correlated, an AR(1) chain with lag one autocorrelation rho
+  // is worth n(1-rho)/(1+rho) independent ones
+  double rho = lag1/var;
+  nEff_ = std::min(std::max(n * (1 - rho)/(1 + rho), 1.), n);
+  error_ = sqrt(var/(n - 1)/nEff_);
+}
+
+bool
+IndexedHMC::Typical(double meanNLLH_, double nEff_) const{
+  // near a mode -log(lh) - min is roughly chi2/2 with nParams dof: mean 
+  // nParams/2, spread sqrt(nParams/2) per sample, less for the mean of a 
+  // window. Both sides matter, a warm start sits at the mode, which is below
+  // the typical set
+  double half = 0.5 * fLayout.GetNParams();
+  return std::abs(meanNLLH_ - fBestFitNLLH - half) < 2 * sqrt(half/nEff_);
+}
+
+void
+IndexedHMC::Run(){
+  size_t nParams = fLayout.GetNParams();
+  const std::vector<double>& minima = fLayout.GetMinima();
+  const std::vector<double>& maxima = fLayout.GetMaxima();
+  const std::vector<int>& nBins = fLayout.GetNBins();
+
+  f1DCounts.clear();
+  f2DCounts.clear();
+  fNLLHChain.clear();
+  fSampleMeans.assign(nParams, 0);
+  fSampleSquares.assign(nParams * nParams, 0);
+  for(size_t i = 0; i < nParams; i++){
+    f1DCounts.push_back(std::vector<double>(nBins[i], 0));
+    for(size_t j = i + 1; j < nParams; j++)
+      f2DCounts.push_back(std::vector<double>(nBins[i] * nBins[j], 0));
+  }
+  fAccepted = 0;
+  fTried = 0;
+  
+  std::vector<double> x = fInitialPoint;
+  if(x.empty())
+    for(size_t i = 0; i < nParams; i++)
+      x.push_back(minima[i] + Rand::Uniform(maxima[i] - minima[i]));
+
+  std::vector<double> grad(nParams);
+  double nllh = fLH.EvaluateGradient(&x[0], &grad[0]);
+  fBestFit = x;
+  fBestFitNLLH = nllh;
+
+  size_t nSamples = std::max(fMaxIter - fBurnIn, 0);
+  fBurnInUsed = fBurnIn;
+  std::vector<double> window;
+  int    nWindows = 0;
+  double lastMean = 0;
+  double lastError = std::numeric_limits<double>::infinity();
+  for(int iter = 0; iter < fMaxIter && fNLLHChain.size() < nSamples; iter++){
+    if(fMaxIter >= 10 && !(iter % (fMaxIter/10)))
+      std::cout << iter << " / " << fMaxIter << "\t acceptance rate "
+                << GetAcceptanceRate() << std::endl;
+
+    fTried++;
+    if(Step(x, nllh, grad))
+      fAccepted++;
+
+    if(nllh < fBestFitNLLH){
+      fBestFitNLLH = nllh;
+      fBestFit = x;
+    }
+
+    if(iter >= fBurnInUsed){
+      Record(x, nllh);
+      continue;
+    }
+
+    if(!fBurnInWindow)
+      continue;
+    window.push_back(nllh);
+    if(window.size() < size_t(fBurnInWindow))
+      continue;
+    if(++nWindows <= fBurnInSkip){
+      window.clear();
+      continue;
+    }
+
+    // stationary: this window and the last agree, and typical: at the right
+    // height above the best fit. Never on the first window checked
+    double mean, error, nEff;
+    WindowStats(window, mean, error, nEff);
+    bool stationary = std::isfinite(error) && std::isfinite(lastError) &&
+                      std::abs(mean - lastMean) < 2 * sqrt(error * error + lastError * lastError);
+    if(stationary && Typical(mean, nEff)){
+      fBurnInUsed = iter + 1;
+      std::cout << "In the typical set after " << fBurnInUsed << " iterations, ending the burn in" 
+                << std::endl;
+    }
+    lastMean = mean;
+    lastError = error;
+    window.clear();
+  }
+}
+
+std::map<std::string, Histogram>
+IndexedHMC::Get1DProjections() const{
+  std::map<std::string, Histogram> projs;
+  for(size_t i = 0; i < f1DCounts.size(); i++){
+    const std::string& name = fLayout.GetName(i);
+    AxisCollection axes;
+    axes.AddAxis(BinAxis(name, fLayout.GetMinima()[i], fLayout.GetMaxima()[i], 
+                         fLayout.GetNBins()[i]));
+    Histogram hist(axes);
+    hist.SetBinContents(f1DCounts.at(i));
+    projs[name] = hist;
+  }
+  return projs;
+}
+
+std::map<std::string, Histogram>
+IndexedHMC::Get2DProjections() const{
+  std::map<std::string, Histogram> projs;
+  size_t nParams = f1DCounts.size();
+  size_t pair = 0;
+  for(size_t i = 0; i < nParams; i++)
+    for(size_t j = i + 1; j < nParams; j++, pair++){
+      const std::string& nameI = fLayout.GetName(i);
+      const std::string& nameJ = fLayout.GetName(j);
+      AxisCollection axes;
+      axes.AddAxis(BinAxis(nameI, fLayout.GetMinima()[i], fLayout.GetMaxima()[i], 
+                           fLayout.GetNBins()[i]));
+      axes.AddAxis(BinAxis(nameJ, fLayout.GetMinima()[j], fLayout.GetMaxima()[j], 
+                           fLayout.GetNBins()[j]));
+      Histogram hist(axes);
+
+      const std::vector<double>& counts = f2DCounts.at(pair);
+      size_t nj = fLayout.GetNBins()[j];
+      std::vector<size_t> indices(2);
+      for(size_t k = 0; k < counts.size(); k++){
+        if(!counts[k])
+          continue;
+        indices[0] = k / nj;
+        indices[1] = k % nj;
+        hist.SetBinContent(axes.FlattenIndices(indices), counts[k]);
+      }
+      projs[nameI + "_" + nameJ] = hist;
+    }
+  return projs;
+}
+
+int
+IndexedHMC::GetNSamples() const{
+  return fNLLHChain.size();
+}
+
+const std::vector<double>&
+IndexedHMC::GetSampleMeans() const{
+  return fSampleMeans;
+}
+
+std::vector<double>
+IndexedHMC::GetSampleCovariance() const{
+  std::vector<double> covariance(fSampleSquares.size(), 0);
+  if(fNLLHChain.size() < 2)
+    return covariance;
+  for(size_t i = 0; i < covariance.size(); i++)
+    covariance[i] = fSampleSquares[i]/(fNLLHChain.size() - 1);
+  return covariance;
+}
+
+std::vector<double>
+IndexedHMC::GetAutoCorrelations() const{
+  size_t n = fNLLHChain.size();
+  std::vector<double> autocors;
+  if(n < 2)
+    return autocors;
+
+  double mean = 0;
+  for(size_t i = 0; i < n; i++)
+    mean += fNLLHChain[i];
+  mean /= n;
+
+  double var = 0;
+  for(size_t i = 0; i < n; i++)
+    var += (fNLLHChain[i] - mean) * (fNLLHChain[i] - mean);
+  if(!var)
+    return autocors;
+
+  for(size_t lag = 0; lag < n/2; lag++){
+    double sum = 0;
+    for(size_t i = 0; i + lag < n; i++)
+      sum += (fNLLHChain[i] - mean) * (fNLLHChain[i + lag] - mean);
+    autocors.push_back(sum/var);
+  }
+  return autocors;
+}
+
+}
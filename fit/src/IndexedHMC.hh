@@ -0,0 +1,92 @@
+#ifndef __BBFIT__IndexedHMC__
+#define __BBFIT__IndexedHMC__
+#include <ParameterLayout.hh>
+#include <vector>
+#include <map>
+#include <string>
+
+class Histogram;
+
+// Hamiltonian MCMC on a contiguous parameter array. Leapfrog steps use the 
+// likelihood's own gradient, the box from the layout is enforced by 
+// reflection. The chain is only turned into named histograms on the way out
+
+namespace bbfit{
+class IndexedLikelihood;
+class IndexedHMC{
+public:
+  IndexedHMC(const IndexedLikelihood& lh_, const ParameterLayout& layout_,
+             double epsilon_, int nSteps_);
+
+  // defaults to 1/sigma^2 from the layout
+  void SetMasses(const std::vector<double>&);
+
+  // defaults to a uniform draw inside the box
+  void SetInitialPoint(const std::vector<double>&);
+
+  void SetMaxIter(int);
+  void SetBurnIn(int);
+
+  // end the burn in once two consecutive windows of window_ iterations agree
+  // on their mean -log(lh) within its standard error, and the second is 
+  // typical of the posterior, about nParams/2 above the best so far, within
+  // what its effective number of samples allows. The first skipWindows_ 
+  // windows are never used, for a start that's known to be off the mode. The
+  // burn in from SetBurnIn is then the most it can be, and the chain stops 
+  // once it has as many samples as a full burn in would have left. 0 to 
+  // switch off
+  void SetAutoBurnIn(int window_, int skipWindows_ = 0);
+  // what the last run actually discarded
+  int  GetBurnInUsed() const;
+
+  void Run();
+
+  const std::vector<double>& GetBestFit() const;
+  double GetBestFitNLLH() const;
+  double GetAcceptanceRate() const;
+
+  std::map<std::string, Histogram> Get1DProjections() const;
+  std::map<std::string, Histogram> Get2DProjections() const;
+
+  // of the post burn in -log(lh) chain
+  std::vector<double> GetAutoCorrelations() const;
+
+  // of the post burn in samples, covariance row major nParams x nParams
+  int GetNSamples() const;
+  const std::vector<double>& GetSampleMeans() const;
+  std::vector<double> GetSampleCovariance() const;
+
+private:
+  bool Step(std::vector<double>& x_, double& nllh_, std::vector<double>& grad_);
+  void Reflect(std::vector<double>& x_, std::vector<double>& p_) const;
+  void Record(const std::vector<double>& x_, double nllh_);
+  void WindowStats(const std::vector<double>& nllhs_, double& mean_, double& error_, 
+                   double& nEff_) const;
+  bool Typical(double meanNLLH_, double nEff_) const;
+  int  FindBin(size_t param_, double val_) const;
+
+  const IndexedLikelihood& fLH;
+  ParameterLayout fLayout;
+  double fEpsilon;
+  int    fNSteps;
+  int    fMaxIter;
+  int    fBurnIn;
+  int    fBurnInWindow;
+  int    fBurnInSkip;
+  int    fBurnInUsed;
+  std::vector<double> fMasses;
+  std::vector<double> fInitialPoint;
+
+  std::vector<double> fBestFit;
+  double fBestFitNLLH;
+  int    fAccepted;
+  int    fTried;
+
+  std::vector<std::vector<double> > f1DCounts;
+  std::vector<std::vector<double> > f2DCounts; // pairs i < j, row major ix * nj + iy
+  std::vector<double> fNLLHChain;
+  std::vector<double> fSampleMeans;
+  std::vector<double> fSampleSquares; // sum of products of deviations, welford
+};
+}
+#endif
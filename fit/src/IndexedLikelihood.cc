@@ -0,0 +1,81 @@
+#include <IndexedLikelihood.hh>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+namespace bbfit{
+
+double
+IndexedLikelihood::EvaluateGradient(const double* params_, double* grad_) const{
+  size_t nParams = GetNParams();
+  std::vector<double> shifted(params_, params_ + nParams);
+  std::vector<double> minima, maxima;
+  GetBounds(minima, maxima);
+
+  for(size_t i = 0; i < nParams; i++){
+    double h = 1e-5 * std::max(std::abs(params_[i]), 1.);
+    double down, up;
+    Stencil(params_[i], h, minima[i], maxima[i], down, up);
+    grad_[i] = 0;
+    if(up <= down)
+      continue;
+    shifted[i] = up;
+    double nllhUp = Evaluate(&shifted[0]);
+    shifted[i] = down;
+    double nllhDown = Evaluate(&shifted[0]);
+    shifted[i] = params_[i];
+    grad_[i] = (nllhUp - nllhDown)/(up - down);
+  }
+  return Evaluate(params_);
+}
+
+void
+IndexedLikelihood::EvaluateHessian(const double* params_, std::vector<double>& hess_) const{
+  size_t nParams = GetNParams();
+  std::vector<double> shifted(params_, params_ + nParams);
+  std::vector<double> gradUp(nParams);
+  std::vector<double> gradDown(nParams);
+  std::vector<double> minima, maxima;
+  GetBounds(minima, maxima);
+  hess_.assign(nParams * nParams, 0);
+
+  // one sided at a bound, e.g. a normalisation at 0, so the curvature only
+  // comes from the allowed region
+  for(size_t i = 0; i < nParams; i++){
+    double h = 1e-4 * std::max(std::abs(params_[i]), 1.);
+    double down, up;
+    Stencil(params_[i], h, minima[i], maxima[i], down, up);
+    if(up <= down)
+      continue;
+    shifted[i] = up;
+    EvaluateGradient(&shifted[0], &gradUp[0]);
+    shifted[i] = down;
+    EvaluateGradient(&shifted[0], &gradDown[0]);
+    shifted[i] = params_[i];
+    for(size_t j = 0; j < nParams; j++)
+      hess_[i * nParams + j] = (gradUp[j] - gradDown[j])/(up - down);
+  }
+
+  // symmetrise
+  for(size_t i = 0; i < nParams; i++)
+    for(size_t j = i + 1; j < nParams; j++){
+      double mean = 0.5 * (hess_[i * nParams + j] + hess_[j * nParams + i]);
+      hess_[i * nParams + j] = hess_[j * nParams + i] = mean;
+    }
+}
+
+void
+IndexedLikelihood::GetBounds(std::vector<double>& minima_, std::vector<double>& maxima_) const{
+  minima_.assign(GetNParams(), -std::numeric_limits<double>::infinity());
+  maxima_.assign(GetNParams(), std::numeric_limits<double>::infinity());
+}
+
+void
+IndexedLikelihood::Stencil(double x_, double h_, double min_, double max_, 
+                           double& down_, double& up_){
+  up_   = std::min(x_ + h_, max_);
+  down_ = std::max(x_ - h_, min_);
+}
+
+}
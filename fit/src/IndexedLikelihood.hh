@@ -0,0 +1,36 @@
+#ifndef __BBFIT__IndexedLikelihood__
+#define __BBFIT__IndexedLikelihood__
+#include <stddef.h>
+#include <vector>
+
+// -log(lh) on a contiguous parameter array, ordered by a ParameterLayout.
+// Evaluation is const so one likelihood can be shared between threads
+
+namespace bbfit{
+class IndexedLikelihood{
+public:
+  virtual ~IndexedLikelihood() {}
+
+  virtual size_t GetNParams() const = 0;
+  virtual double Evaluate(const double* params_) const = 0;
+
+  // fills grad_ with d(-log(lh))/dparam and returns -log(lh)
+  // default is central finite differences, override if you can do better
+  virtual double EvaluateGradient(const double* params_, double* grad_) const;
+
+  // second derivatives of -log(lh), row major nParams x nParams
+  // default is central finite differences of the gradient
+  virtual void EvaluateHessian(const double* params_, std::vector<double>& hess_) const;
+
+  // where the parameters are allowed to be, the finite differences stay 
+  // inside. Default is unbounded
+  virtual void GetBounds(std::vector<double>& minima_, std::vector<double>& maxima_) const;
+
+protected:
+  // h_ either side of x_ but never outside [min_, max_], one sided at a 
+  // bound. Divide by up_ - down_, the step actually taken
+  static void Stencil(double x_, double h_, double min_, double max_, 
+                      double& down_, double& up_);
+};
+}
+#endif
@@ -0,0 +1,197 @@
+#include <LaplaceApproximation.hh>
+#include <Histogram.h>
+#include <AxisCollection.h>
+#include <BinAxis.h>
+#include <Exceptions.h>
+#include <iostream>
+#include <fstream>
+#include <cmath>
+
+namespace bbfit{
+
+bool
+LaplaceApproximation::InvertSymmetric(const std::vector<double>& mat_, size_t n_, 
+                                      std::vector<double>& inv_){
+  // A = L L^T
+  std::vector<double> l(n_ * n_, 0);
+  for(size_t i = 0; i < n_; i++)
+    for(size_t j = 0; j <= i; j++){
+      double sum = mat_[i * n_ + j];
+      for(size_t k = 0; k < j; k++)
+        sum -= l[i * n_ + k] * l[j * n_ + k];
+      if(i == j){
+        if(sum <= 0)
+          return false;
+        l[i * n_ + i] = sqrt(sum);
+      }
+      else
+        l[i * n_ + j] = sum/l[j * n_ + j];
+    }
+
+  // L^-1, then A^-1 = L^-T L^-1
+  std::vector<double> lInv(n_ * n_, 0);
+  for(size_t i = 0; i < n_; i++){
+    lInv[i * n_ + i] = 1/l[i * n_ + i];
+    for(size_t j = 0; j < i; j++){
+      double sum = 0;
+      for(size_t k = j; k < i; k++)
+        sum -= l[i * n_ + k] * lInv[k * n_ + j];
+      lInv[i * n_ + j] = sum/l[i * n_ + i];
+    }
+  }
+
+  inv_.assign(n_ * n_, 0);
+  for(size_t i = 0; i < n_; i++)
+    for(size_t j = 0; j <= i; j++){
+      double sum = 0;
+      for(size_t k = i; k < n_; k++)
+        sum += lInv[k * n_ + i] * lInv[k * n_ + j];
+      inv_[i * n_ + j] = inv_[j * n_ + i] = sum;
+    }
+  return true;
+}
+
+LaplaceApproximation::LaplaceApproximation(const ParameterLayout& layout_, 
+                                           const std::vector<double>& mode_,
+                                           const std::vector<double>& hessian_)
+  : fLayout(layout_), fMode(mode_){
+  size_t n = fLayout.GetNParams();
+  if(mode_.size() != n || hessian_.size() != n * n)
+    throw DimensionError("LaplaceApproximation::mode/hessian don't match the layout");
+
+  // parameters the data can't see at all would make the hessian singular, 
+  // give them the configured width instead
+  std::vector<double> hess = hessian_;
+  const std::vector<double>& sigmas = fLayout.GetSigmas();
+  for(size_t i = 0; i < n; i++)
+    if(hess[i * n + i] <= 0){
+      std::cout << "LaplaceApproximation::Warning " << fLayout.GetName(i) 
+                << " is unconstrained at the mode, using sigma from the config" 
+                << std::endl;
+      for(size_t j = 0; j < n; j++)
+        hess[i * n + j] = hess[j * n + i] = 0;
+      hess[i * n + i] = 1/(sigmas[i] * sigmas[i]);
+    }
+
+  if(!InvertSymmetric(hess, n, fCovariance))
+    throw ValueError("LaplaceApproximation::Hessian at the mode isn't positive definite");
+}
+
+const std::vector<double>&
+LaplaceApproximation::GetMode() const{
+  return fMode;
+}
+
+const std::vector<double>&
+LaplaceApproximation::GetCovariance() const{
+  return fCovariance;
+}
+
+std::vector<double>
+LaplaceApproximation::GetErrors() const{
+  size_t n = fLayout.GetNParams();
+  std::vector<double> errs(n);
+  for(size_t i = 0; i < n; i++)
+    errs[i] = sqrt(fCovariance[i * n + i]);
+  return errs;
+}
+
+std::map<std::string, Histogram>
+LaplaceApproximation::Get1DProjections() const{
+  std::map<std::string, Histogram> projs;
+  std::vector<double> errs = GetErrors();
+
+  for(size_t i = 0; i < fLayout.GetNParams(); i++){
+    const std::string& name = fLayout.GetName(i);
+    double min = fLayout.GetMinima()[i];
+    double max = fLayout.GetMaxima()[i];
+    int nBins  = fLayout.GetNBins()[i];
+    AxisCollection axes;
+    axes.AddAxis(BinAxis(name, min, max, nBins));
+
+    // probability in each bin, truncated to the box
+    std::vector<double> contents(nBins);
+    double width = (max - min)/nBins;
+    for(int iBin = 0; iBin < nBins; iBin++){
+      double lo = (min + iBin * width - fMode[i])/(sqrt(2.) * errs[i]);
+      double hi = (min + (iBin + 1) * width - fMode[i])/(sqrt(2.) * errs[i]);
+      contents[iBin] = 0.5 * (erf(hi) - erf(lo));
+    }
+
+    Histogram hist(axes);
+    hist.SetBinContents(contents);
+    if(hist.Integral())
+      hist.Normalise();
+    projs[name] = hist;
+  }
+  return projs;
+}
+
+std::map<std::string, Histogram>
+LaplaceApproximation::Get2DProjections() const{
+  std::map<std::string, Histogram> projs;
+  size_t n = fLayout.GetNParams();
+  const std::vector<double>& minima = fLayout.GetMinima();
+  const std::vector<double>& maxima = fLayout.GetMaxima();
+  const std::vector<int>& nBins = fLayout.GetNBins();
+
+  for(size_t i = 0; i < n; i++)
+    for(size_t j = i + 1; j < n; j++){
+      // the marginal of a gaussian is the gaussian of the sub-covariance
+      double vi  = fCovariance[i * n + i];
+      double vj  = fCovariance[j * n + j];
+      double cij = fCovariance[i * n + j];
+      double det = vi * vj - cij * cij;
+
+      AxisCollection axes;
+      axes.AddAxis(BinAxis(fLayout.GetName(i), minima[i], maxima[i], nBins[i]));
+      axes.AddAxis(BinAxis(fLayout.GetName(j), minima[j], maxima[j], nBins[j]));
+      Histogram hist(axes);
+
+      double wi = (maxima[i] - minima[i])/nBins[i];
+      double wj = (maxima[j] - minima[j])/nBins[j];
+      std::vector<size_t> indices(2);
+      for(int bi = 0; bi < nBins[i]; bi++)
+        for(int bj = 0; bj < nBins[j]; bj++){
+          double di = minima[i] + (bi + 0.5) * wi - fMode[i];
+          double dj = minima[j] + (bj + 0.5) * wj - fMode[j];
+          double chi2 = (vj * di * di - 2 * cij * di * dj + vi * dj * dj)/det;
+          indices[0] = bi;
+          indices[1] = bj;
+          hist.SetBinContent(axes.FlattenIndices(indices), exp(-0.5 * chi2));
+        }
+
+      if(hist.Integral())
+        hist.Normalise();
+      projs[fLayout.GetName(i) + "_" + fLayout.GetName(j)] = hist;
+    }
+  return projs;
+}
+
+void
+LaplaceApproximation::SaveCovariance(const std::string& fileName_) const{
+  SaveCovariance(fLayout, fCovariance, fileName_);
+}
+
+void
+LaplaceApproximation::SaveCovariance(const ParameterLayout& layout_, const std::vector<double>& covariance_,
+                                     const std::string& fileName_){
+  size_t n = layout_.GetNParams();
+  if(covariance_.size() != n * n)
+    throw DimensionError(Formatter() << "LaplaceApproximation::Covariance has " << covariance_.size()
+                         << " entries for " << n << " parameters");
+  std::ofstream ofs(fileName_.c_str());
+  ofs << "#";
+  for(size_t i = 0; i < n; i++)
+    ofs << "\t" << layout_.GetName(i);
+  ofs << "\n";
+  for(size_t i = 0; i < n; i++){
+    ofs << layout_.GetName(i);
+    for(size_t j = 0; j < n; j++)
+      ofs << "\t" << covariance_[i * n + j];
+    ofs << "\n";
+  }
+  ofs.close();
+}
+
+}
@@ -0,0 +1,45 @@
+#ifndef __BBFIT__LaplaceApproximation__
+#define __BBFIT__LaplaceApproximation__
+#include <ParameterLayout.hh>
+#include <vector>
+#include <map>
+#include <string>
+
+class Histogram;
+
+// Gaussian approximation to the posterior around the mode, covariance is the
+// inverse of the -log(lh) hessian there. Projections come out on the same
+// binning and with the same names as the MCMC ones so the downstream scripts
+// can't tell the difference
+
+namespace bbfit{
+class LaplaceApproximation{
+public:
+  LaplaceApproximation(const ParameterLayout& layout_, 
+                       const std::vector<double>& mode_,
+                       const std::vector<double>& hessian_);
+
+  const std::vector<double>& GetMode() const;
+  const std::vector<double>& GetCovariance() const;
+  std::vector<double> GetErrors() const;
+
+  std::map<std::string, Histogram> Get1DProjections() const;
+  std::map<std::string, Histogram> Get2DProjections() const;
+
+  void SaveCovariance(const std::string& fileName_) const;
+  // any covariance on layout_, e.g. an MCMC sample's, in the same format
+  static void SaveCovariance(const ParameterLayout& layout_, const std::vector<double>& covariance_,
+                             const std::string& fileName_);
+
+  // inverse of a symmetric positive definite matrix by cholesky decomposition, 
+  // returns false if it isn't positive definite
+  static bool InvertSymmetric(const std::vector<double>& mat_, size_t n_, 
+                              std::vector<double>& inv_);
+
+private:
+  ParameterLayout     fLayout;
+  std::vector<double> fMode;
+  std::vector<double> fCovariance;
+};
+}
+#endif
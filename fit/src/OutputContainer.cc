@@ -0,0 +1,134 @@
+#include <OutputContainer.hh>
+#include <BinnedED.h>
+#include <Histogram.h>
+#include <DistTools.h>
+#include <HistTools.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <TFile.h>
+#include <TH1D.h>
+#include <TH2D.h>
+#include <thread>
+#include <functional>
+#include <algorithm>
+
+namespace bbfit{
+
+OutputContainer::OutputContainer(const std::string& path_){
+  fPath = path_;
+  fFile = new TFile(path_.c_str(), "RECREATE");
+  if(fFile->IsZombie()){
+    delete fFile;
+    throw IOError("OutputContainer:: couldn't create " + path_);
+  }
+}
+
+OutputContainer::~OutputContainer(){
+  fFile->Close();
+  delete fFile;
+}
+
+void
+OutputContainer::Add(const std::string& name_, const BinnedED& dist_){
+  if(dist_.GetNDims() == 1){
+    TH1D h = DistTools::ToTH1D(dist_);
+    h.SetName(name_.c_str());
+    h.SetDirectory(0);
+    fFile->WriteTObject(&h, name_.c_str());
+  }
+  else if(dist_.GetNDims() == 2){
+    TH2D h = DistTools::ToTH2D(dist_);
+    h.SetName(name_.c_str());
+    h.SetDirectory(0);
+    fFile->WriteTObject(&h, name_.c_str());
+  }
+  else
+    throw DimensionError(Formatter() << "OutputContainer::Add " << name_ << " has " 
+                         << dist_.GetNDims() << " dimensions, only 1 or 2 can be saved to " << fPath);
+}
+
+void
+OutputContainer::Add(const std::string& name_, const Histogram& hist_){
+  Add(name_, BinnedED(name_, hist_));
+}
+
+std::string
+OutputContainer::PathFor(const std::string& dir_){
+  std::string dir = dir_;
+  while(dir.size() > 1 && dir[dir.size() - 1] == '/')
+    dir.erase(dir.size() - 1);
+  return dir + ".root";
+}
+
+void
+OutputContainer::Save(const std::vector<BinnedED>& dists_, const std::string& dir_, 
+                      bool container_){
+  if(container_){
+    OutputContainer out(PathFor(dir_));
+    for(size_t i = 0; i < dists_.size(); i++)
+      out.Add(dists_.at(i).GetName(), dists_.at(i));
+    return;
+  }
+
+  for(size_t i = 0; i < dists_.size(); i++){
+    const BinnedED& dist = dists_.at(i);
+    std::string path = dir_ + "/" + dist.GetName() + ".root";
+    if(dist.GetNDims() == 1)
+      DistTools::ToTH1D(dist).SaveAs(path.c_str());
+    else
+      DistTools::ToTH2D(dist).SaveAs(path.c_str());
+  }
+}
+
+// projections if axis_ is empty, otherwise 1D slices along axis_
+static void
+ProjectChunk(const std::vector<BinnedED>& dists_, const std::string& axis_, 
+             size_t first_, size_t last_, std::vector<std::vector<BinnedED> >& projs_){
+  for(size_t i = first_; i < last_; i++){
+    if(dists_.at(i).GetNDims() < 2)
+      continue;
+    if(axis_.empty())
+      projs_[i] = HistTools::GetVisualisableProjections(dists_.at(i));
+    else
+      projs_[i] = HistTools::Get1DSlices(dists_.at(i), axis_);
+  }
+}
+
+static std::vector<BinnedED>
+ProjectAll(const std::vector<BinnedED>& dists_, const std::string& axis_, unsigned nThreads_){
+  // only the marginalisation is threaded, root objects are made afterwards on 
+  // the calling thread
+  if(!nThreads_)
+    nThreads_ = std::thread::hardware_concurrency();
+  if(!nThreads_)
+    nThreads_ = 1;
+
+  std::vector<std::vector<BinnedED> > projs(dists_.size());
+  std::vector<std::thread> threads;
+  size_t chunk = (dists_.size() + nThreads_ - 1) / nThreads_;
+  for(size_t first = 0; first < dists_.size(); first += chunk){
+    size_t last = std::min(first + chunk, dists_.size());
+    threads.push_back(std::thread(ProjectChunk, std::cref(dists_), std::cref(axis_), 
+                                  first, last, std::ref(projs)));
+  }
+  for(size_t i = 0; i < threads.size(); i++)
+    threads[i].join();
+
+  std::vector<BinnedED> all;
+  for(size_t i = 0; i < projs.size(); i++)
+    all.insert(all.end(), projs[i].begin(), projs[i].end());
+  return all;
+}
+
+std::vector<BinnedED>
+OutputContainer::Projections(const std::vector<BinnedED>& dists_, unsigned nThreads_){
+  return ProjectAll(dists_, "", nThreads_);
+}
+
+std::vector<BinnedED>
+OutputContainer::Slices(const std::vector<BinnedED>& dists_, const std::string& axis_, 
+                        unsigned nThreads_){
+  return ProjectAll(dists_, axis_, nThreads_);
+}
+
+}
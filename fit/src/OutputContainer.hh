@@ -0,0 +1,47 @@
+// All the small histograms of a run (projections, slices, lh projections) in a 
+// single root file instead of one file each. Every histogram is keyed by the 
+// name its own file would have had, minus the .root, so <dir>/<name>.root 
+// becomes key <name> in <dir>.root
+#ifndef __BBFIT__OutputContainer__
+#define __BBFIT__OutputContainer__
+#include <string>
+#include <vector>
+
+class BinnedED;
+class Histogram;
+class TFile;
+
+namespace bbfit{
+class OutputContainer{
+public:
+  OutputContainer(const std::string& path_);
+  ~OutputContainer();
+
+  // as a TH1D or TH2D
+  void Add(const std::string& name_, const BinnedED&);
+  void Add(const std::string& name_, const Histogram&);
+
+  // the container standing in for the directory dir_
+  static std::string PathFor(const std::string& dir_);
+
+  // each dist under its own name, either as dir_/<name>.root or in PathFor(dir_)
+  static void Save(const std::vector<BinnedED>& dists_, const std::string& dir_, 
+                   bool container_);
+
+  // the visualisable projections of all the dists, one dist per thread
+  static std::vector<BinnedED> Projections(const std::vector<BinnedED>& dists_, 
+                                           unsigned nThreads_ = 0);
+
+  // 1D slices of all the dists along axis_, the same way
+  static std::vector<BinnedED> Slices(const std::vector<BinnedED>& dists_, 
+                                      const std::string& axis_, unsigned nThreads_ = 0);
+
+private:
+  OutputContainer(const OutputContainer&);
+  OutputContainer& operator=(const OutputContainer&);
+
+  std::string fPath;
+  TFile*      fFile;
+};
+}
+#endif
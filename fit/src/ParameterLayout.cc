@@ -0,0 +1,105 @@
+#include <ParameterLayout.hh>
+#include <FitConfig.hh>
+#include <Exceptions.h>
+
+namespace bbfit{
+
+ParameterLayout::ParameterLayout(const FitConfig& config_){
+  typedef std::set<std::string> StringSet;
+  StringSet names = config_.GetParamNames();
+  const ParameterDict& minima = config_.GetMinima();
+  const ParameterDict& maxima = config_.GetMaxima();
+  const ParameterDict& sigmas = config_.GetSigmas();
+  const ParameterDict& nbins  = config_.GetNBins();
+
+  for(StringSet::iterator it = names.begin(); it != names.end(); ++it)
+    AddParameter(*it, minima.at(*it), maxima.at(*it), sigmas.at(*it), 
+                 nbins.at(*it));
+}
+
+void
+ParameterLayout::AddParameter(const std::string& name_, double min_, double max_, 
+                              double sigma_, int nbins_){
+  if(fIndices.count(name_))
+    throw ValueError("ParameterLayout::Parameter " + name_ + " already exists!");
+  
+  fIndices[name_] = fNames.size();
+  fNames.push_back(name_);
+  fMinima.push_back(min_);
+  fMaxima.push_back(max_);
+  fSigmas.push_back(sigma_);
+  fNBins.push_back(nbins_);
+}
+
+size_t
+ParameterLayout::GetNParams() const{
+  return fNames.size();
+}
+
+bool
+ParameterLayout::HasParameter(const std::string& name_) const{
+  return fIndices.count(name_);
+}
+
+size_t
+ParameterLayout::GetIndex(const std::string& name_) const{
+  std::map<std::string, size_t>::const_iterator it = fIndices.find(name_);
+  if(it == fIndices.end())
+    throw NotFoundError("ParameterLayout::No parameter called " + name_);
+  return it->second;
+}
+
+const std::string&
+ParameterLayout::GetName(size_t index_) const{
+  return fNames.at(index_);
+}
+
+const std::vector<std::string>&
+ParameterLayout::GetNames() const{
+  return fNames;
+}
+
+const std::vector<double>&
+ParameterLayout::GetMinima() const{
+  return fMinima;
+}
+
+const std::vector<double>&
+ParameterLayout::GetMaxima() const{
+  return fMaxima;
+}
+
+const std::vector<double>&
+ParameterLayout::GetSigmas() const{
+  return fSigmas;
+}
+
+const std::vector<int>&
+ParameterLayout::GetNBins() const{
+  return fNBins;
+}
+
+std::vector<double>
+ParameterLayout::ToVector(const ParameterDict& dict_) const{
+  std::vector<double> vals(fNames.size());
+  for(size_t i = 0; i < fNames.size(); i++){
+    ParameterDict::const_iterator it = dict_.find(fNames.at(i));
+    if(it == dict_.end())
+      throw NotFoundError("ParameterLayout::No value given for " + fNames.at(i));
+    vals[i] = it->second;
+  }
+  return vals;
+}
+
+ParameterDict
+ParameterLayout::ToDict(const std::vector<double>& vals_) const{
+  if(vals_.size() != fNames.size())
+    throw DimensionError(Formatter() << "ParameterLayout::Expected " << fNames.size()
+                         << " values, got " << vals_.size());
+  ParameterDict dict;
+  for(size_t i = 0; i < fNames.size(); i++)
+    dict[fNames.at(i)] = vals_.at(i);
+  return dict;
+}
+
+}
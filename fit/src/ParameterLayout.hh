@@ -0,0 +1,47 @@
+#ifndef __BBFIT__ParameterLayout__
+#define __BBFIT__ParameterLayout__
+#include <ParameterDict.h>
+#include <string>
+#include <vector>
+#include <map>
+
+// Maps fit parameter names to dense indices, once, at setup time.
+// Everything downstream of the layout (likelihoods, samplers, minimisers)
+// works on contiguous double arrays in this order; the dictionaries only
+// come back out for configuration and output
+
+namespace bbfit{
+class FitConfig;
+class ParameterLayout{
+public:
+  ParameterLayout() {}
+  ParameterLayout(const FitConfig&);
+
+  void AddParameter(const std::string& name_, double min_, double max_, 
+                    double sigma_, int nbins_);
+
+  size_t GetNParams() const;
+  bool   HasParameter(const std::string& name_) const;
+  size_t GetIndex(const std::string& name_) const;
+  const std::string& GetName(size_t index_) const;
+  const std::vector<std::string>& GetNames() const;
+
+  const std::vector<double>& GetMinima() const;
+  const std::vector<double>& GetMaxima() const;
+  const std::vector<double>& GetSigmas() const;
+  const std::vector<int>&    GetNBins() const;
+
+  // conversions at the config/output boundary
+  std::vector<double> ToVector(const ParameterDict&) const;
+  ParameterDict       ToDict(const std::vector<double>&) const;
+
+private:
+  std::vector<std::string> fNames;
+  std::map<std::string, size_t> fIndices;
+  std::vector<double> fMinima;
+  std::vector<double> fMaxima;
+  std::vector<double> fSigmas;
+  std::vector<int>    fNBins;
+};
+}
+#endif
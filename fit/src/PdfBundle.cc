@@ -0,0 +1,159 @@
+#include <PdfBundle.hh>
+#include <BinnedED.h>
+#include <Histogram.h>
+#include <BinAxis.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <H5Cpp.h>
+#include <algorithm>
+
+namespace bbfit{
+
+// one dimensional array of doubles
+static void
+WriteArray(const H5::Group& group_, const std::string& name_, const std::vector<double>& vals_){
+  hsize_t dims[1] = {vals_.size()};
+  H5::DataSpace space(1, dims);
+  H5::DataSet ds = group_.createDataSet(name_, H5::PredType::NATIVE_DOUBLE, space);
+  if(!vals_.empty())
+    ds.write(&vals_.at(0), H5::PredType::NATIVE_DOUBLE);
+}
+
+static std::vector<double>
+ReadArray(const H5::Group& group_, const std::string& name_){
+  H5::DataSet ds = group_.openDataSet(name_);
+  std::vector<double> vals(ds.getSpace().getSimpleExtentNpoints());
+  if(!vals.empty())
+    ds.read(&vals.at(0), H5::PredType::NATIVE_DOUBLE);
+  return vals;
+}
+
+static void
+WriteString(const H5::Group& group_, const std::string& name_, const std::string& val_){
+  H5::StrType strType(H5::PredType::C_S1, H5T_VARIABLE);
+  H5::Attribute attr = group_.createAttribute(name_, strType, H5::DataSpace(H5S_SCALAR));
+  attr.write(strType, val_);
+}
+
+static std::string
+ReadString(const H5::Group& group_, const std::string& name_){
+  H5::Attribute attr = group_.openAttribute(name_);
+  H5std_string val;
+  attr.read(attr.getStrType(), val);
+  return val;
+}
+
+PdfBundle::PdfBundle(const std::string& path_){
+  fPath = path_;
+  fFile = NULL;
+  // the destructor won't run if this throws, so the file is closed here
+  try{
+    fFile = new H5::H5File(path_, H5F_ACC_RDONLY);
+
+    H5::Group axes = fFile->openGroup("/axes");
+    for(hsize_t i = 0; i < axes.getNumObjs(); i++){
+      H5::Group axis = fFile->openGroup(Formatter() << "/axes/" << i);
+      fAxes.AddAxis(BinAxis(ReadString(axis, "name"), ReadArray(axis, "low_edges"),
+                            ReadArray(axis, "high_edges"), ReadString(axis, "latex")));
+    }
+
+    H5::Group pdfs = fFile->openGroup("/pdfs");
+    for(hsize_t i = 0; i < pdfs.getNumObjs(); i++)
+      fNames.push_back(pdfs.getObjnameByIdx(i));
+  }
+  catch(const H5::Exception& e_){
+    delete fFile;
+    throw IOError("PdfBundle:: couldn't read " + path_ + " : " + e_.getDetailMsg());
+  }
+  catch(...){
+    delete fFile;
+    throw;
+  }
+}
+
+PdfBundle::~PdfBundle(){
+  fFile->close();
+  delete fFile;
+}
+
+const AxisCollection&
+PdfBundle::GetAxes() const{
+  return fAxes;
+}
+
+const std::vector<std::string>&
+PdfBundle::GetNames() const{
+  return fNames;
+}
+
+bool
+PdfBundle::Has(const std::string& name_) const{
+  return std::find(fNames.begin(), fNames.end(), name_) != fNames.end();
+}
+
+Histogram
+PdfBundle::LoadHistogram(const std::string& name_) const{
+  if(!Has(name_))
+    throw NotFoundError("PdfBundle:: no pdf " + name_ + " in " + fPath);
+
+  std::vector<double> contents;
+  try{
+    contents = ReadArray(fFile->openGroup("/pdfs"), name_);
+  }
+  catch(const H5::Exception& e_){
+    throw IOError("PdfBundle:: couldn't read " + name_ + " from " + fPath + " : " + e_.getDetailMsg());
+  }
+
+  Histogram hist(fAxes);
+  if(contents.size() != hist.GetNBins())
+    throw DimensionError(Formatter() << "PdfBundle:: " << name_ << " has " << contents.size() 
+                         << " bins, axes have " << hist.GetNBins());
+  hist.SetBinContents(contents);
+  return hist;
+}
+
+BinnedED
+PdfBundle::Load(const std::string& name_) const{
+  return BinnedED(name_, LoadHistogram(name_));
+}
+
+void
+PdfBundle::Save(const std::string& path_, const std::vector<BinnedED>& dists_){
+  if(dists_.empty())
+    return;
+
+  const AxisCollection& axes = dists_.at(0).GetAxes();
+  for(size_t i = 1; i < dists_.size(); i++)
+    if(dists_.at(i).GetNBins() != dists_.at(0).GetNBins() || 
+       dists_.at(i).GetNDims() != dists_.at(0).GetNDims())
+      throw DimensionError("PdfBundle::Save " + dists_.at(i).GetName() + " is binned differently to " 
+                           + dists_.at(0).GetName() + ", they can't share axes");
+
+  try{
+    H5::H5File file(path_, H5F_ACC_TRUNC);
+    file.createGroup("/axes");
+    for(size_t d = 0; d < axes.GetNDimensions(); d++){
+      const BinAxis& axis = axes.GetAxis(d);
+      H5::Group group = file.createGroup(Formatter() << "/axes/" << d);
+      WriteString(group, "name", axis.GetName());
+      WriteString(group, "latex", axis.GetLatexName());
+      WriteArray(group, "low_edges", axis.GetBinLowEdges());
+      WriteArray(group, "high_edges", axis.GetBinHighEdges());
+    }
+
+    H5::Group pdfs = file.createGroup("/pdfs");
+    for(size_t i = 0; i < dists_.size(); i++)
+      WriteArray(pdfs, dists_.at(i).GetName(), dists_.at(i).GetBinContents());
+    file.close();
+  }
+  catch(const H5::Exception& e_){
+    throw IOError("PdfBundle::Save couldn't write " + path_ + " : " + e_.getDetailMsg());
+  }
+}
+
+std::string
+PdfBundle::BundlePath(const std::string& dir_){
+  return dir_ + "/pdf_bundle.h5";
+}
+
+}
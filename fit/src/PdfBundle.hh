@@ -0,0 +1,47 @@
+// All the pdfs from one directory in a single HDF5 file: the (shared) axes are
+// stored once, each pdf is just its bin contents. Reading opens the file once
+// and pulls pdfs out on demand
+#ifndef __BBFIT__PdfBundle__
+#define __BBFIT__PdfBundle__
+#include <AxisCollection.h>
+#include <string>
+#include <vector>
+
+class BinnedED;
+class Histogram;
+namespace H5{
+class H5File;
+}
+
+namespace bbfit{
+class PdfBundle{
+public:
+  // opens an existing bundle for reading
+  PdfBundle(const std::string& path_);
+  ~PdfBundle();
+
+  const AxisCollection& GetAxes() const;
+  const std::vector<std::string>& GetNames() const;
+  bool Has(const std::string& name_) const;
+
+  // only this pdf is read
+  Histogram LoadHistogram(const std::string& name_) const;
+  BinnedED  Load(const std::string& name_) const;
+
+  // all the dists must have the same binning
+  static void Save(const std::string& path_, const std::vector<BinnedED>& dists_);
+
+  // where the bundle for a pdf directory lives
+  static std::string BundlePath(const std::string& dir_);
+
+private:
+  PdfBundle(const PdfBundle&);
+  PdfBundle& operator=(const PdfBundle&);
+
+  std::string    fPath;
+  H5::H5File*    fFile;
+  AxisCollection fAxes;
+  std::vector<std::string> fNames;
+};
+}
+#endif
@@ -0,0 +1,211 @@
+#include <SharedPdfStore.hh>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <stdint.h>
+#include <sstream>
+#include <iomanip>
+
+namespace bbfit{
+
+// at the start of the segment, followed by the names (newline separated, 
+// padded to 8 bytes) and then the matrix
+struct SharedPdfHeader{
+  char     fMagic[8];
+  uint64_t fNPdfs;
+  uint64_t fNBins;
+  uint64_t fNameBytes;
+  uint64_t fComplete; // set last, a segment from a publisher that died is ignored
+};
+
+static const char kMagic[8] = {'B', 'B', 'F', 'I', 'T', 'P', 'D', '1'};
+
+static std::string
+HashKey(const std::string& key_){
+  // FNV-1a
+  unsigned long long h = 14695981039346656037ULL;
+  for(size_t i = 0; i < key_.size(); i++){
+    h ^= (unsigned char)key_[i];
+    h *= 1099511628211ULL;
+  }
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << h;
+  return hex.str();
+}
+
+static size_t
+PaddedNameBytes(size_t bytes_){
+  return (bytes_ + 7) / 8 * 8;
+}
+
+SharedPdfStore::SharedPdfStore(const std::string& key_) : fCreateFd(-1), fUsersFd(-1), fMap(NULL), 
+                                                          fMapSize(0), fNBins(0), fProbs(NULL){
+  std::string hash = HashKey(key_);
+  fSegName  = "/bbfit_pdfs_" + hash;
+
+  // never unlinked: a process could be waiting on these inodes
+  fCreateFd = OpenLock("/tmp/bbfit_pdfs_" + hash + ".create");
+  fUsersFd  = OpenLock("/tmp/bbfit_pdfs_" + hash + ".users");
+
+  if(flock(fCreateFd, LOCK_EX) == -1 || flock(fUsersFd, LOCK_SH) == -1){
+    close(fCreateFd);
+    close(fUsersFd);
+    throw IOError(Formatter() << "SharedPdfStore:: couldn't lock " << fSegName << " : " << strerror(errno));
+  }
+
+  if(Attach())
+    flock(fCreateFd, LOCK_UN);
+}
+
+SharedPdfStore::~SharedPdfStore(){
+  if(fMap)
+    munmap(fMap, fMapSize);
+
+  // nobody attaches while we look, and the last one out cleans up
+  flock(fCreateFd, LOCK_EX);
+  if(flock(fUsersFd, LOCK_EX | LOCK_NB) == 0)
+    shm_unlink(fSegName.c_str());
+  close(fUsersFd);
+  close(fCreateFd);
+}
+
+int
+SharedPdfStore::OpenLock(const std::string& path_){
+  int fd = open(path_.c_str(), O_RDWR | O_CREAT, 0666);
+  if(fd == -1)
+    throw IOError(Formatter() << "SharedPdfStore:: couldn't open lock file " << path_ 
+                  << " : " << strerror(errno));
+  return fd;
+}
+
+bool
+SharedPdfStore::Attach(){
+  int fd = shm_open(fSegName.c_str(), O_RDONLY, 0);
+  if(fd == -1)
+    return false;
+
+  struct stat st;
+  if(fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(SharedPdfHeader)){
+    close(fd);
+    return false;
+  }
+  Map(fd, st.st_size);
+  close(fd);
+
+  const SharedPdfHeader* header = static_cast<const SharedPdfHeader*>(fMap);
+  size_t expected = sizeof(SharedPdfHeader) + PaddedNameBytes(header->fNameBytes) 
+                    + header->fNPdfs * header->fNBins * sizeof(double);
+  if(memcmp(header->fMagic, kMagic, sizeof(kMagic)) || !header->fComplete 
+     || expected != fMapSize){
+    munmap(fMap, fMapSize);
+    fMap = NULL;
+    fMapSize = 0;
+    return false;
+  }
+
+  const char* names = static_cast<const char*>(fMap) + sizeof(SharedPdfHeader);
+  std::istringstream ss(std::string(names, header->fNameBytes));
+  std::string name;
+  while(std::getline(ss, name))
+    fNames.push_back(name);
+
+  fNBins = header->fNBins;
+  fProbs = reinterpret_cast<const double*>(names + PaddedNameBytes(header->fNameBytes));
+  return true;
+}
+
+void
+SharedPdfStore::Map(int fd_, size_t size_){
+  fMap = mmap(NULL, size_, PROT_READ, MAP_SHARED, fd_, 0);
+  if(fMap == MAP_FAILED){
+    fMap = NULL;
+    throw IOError(Formatter() << "SharedPdfStore:: couldn't map " << fSegName << " : " << strerror(errno));
+  }
+  fMapSize = size_;
+}
+
+void
+SharedPdfStore::Publish(const std::vector<std::string>& names_, size_t nBins_, 
+                        const std::vector<double>& probs_){
+  if(IsAttached())
+    throw ValueError("SharedPdfStore::Publish " + fSegName + " is already attached");
+  if(probs_.size() != nBins_ * names_.size())
+    throw DimensionError(Formatter() << "SharedPdfStore::Publish expected " << nBins_ * names_.size()
+                         << " probabilities, got " << probs_.size());
+
+  std::string names;
+  for(size_t i = 0; i < names_.size(); i++)
+    names += names_.at(i) + "\n";
+  size_t size = sizeof(SharedPdfHeader) + PaddedNameBytes(names.size()) + probs_.size() * sizeof(double);
+
+  // whatever is there is left over from a publisher that died part way
+  shm_unlink(fSegName.c_str());
+  int fd = shm_open(fSegName.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if(fd == -1)
+    throw IOError(Formatter() << "SharedPdfStore:: couldn't create " << fSegName << " : " << strerror(errno));
+  if(ftruncate(fd, size) == -1){
+    close(fd);
+    shm_unlink(fSegName.c_str());
+    throw IOError(Formatter() << "SharedPdfStore:: couldn't size " << fSegName << " : " << strerror(errno));
+  }
+
+  void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if(map == MAP_FAILED){
+    close(fd);
+    shm_unlink(fSegName.c_str());
+    throw IOError(Formatter() << "SharedPdfStore:: couldn't map " << fSegName << " : " << strerror(errno));
+  }
+
+  SharedPdfHeader* header = static_cast<SharedPdfHeader*>(map);
+  memcpy(header->fMagic, kMagic, sizeof(kMagic));
+  header->fNPdfs = names_.size();
+  header->fNBins = nBins_;
+  header->fNameBytes = names.size();
+  header->fComplete = 0;
+  char* namesOut = static_cast<char*>(map) + sizeof(SharedPdfHeader);
+  memcpy(namesOut, names.data(), names.size());
+  if(!probs_.empty())
+    memcpy(namesOut + PaddedNameBytes(names.size()), &probs_[0], probs_.size() * sizeof(double));
+  header->fComplete = 1;
+  munmap(map, size);
+
+  // from now on read only, like everyone else
+  bool ok = Attach();
+  close(fd);
+  if(!ok)
+    throw IOError("SharedPdfStore:: couldn't attach to " + fSegName + " after publishing it");
+  flock(fCreateFd, LOCK_UN);
+}
+
+bool
+SharedPdfStore::IsAttached() const{
+  return fMap != NULL;
+}
+
+const std::vector<std::string>&
+SharedPdfStore::GetNames() const{
+  return fNames;
+}
+
+size_t
+SharedPdfStore::GetNBins() const{
+  return fNBins;
+}
+
+const double*
+SharedPdfStore::GetProbs() const{
+  return fProbs;
+}
+
+const std::string&
+SharedPdfStore::GetSegmentName() const{
+  return fSegName;
+}
+
+}
@@ -0,0 +1,56 @@
+// Read-only copy of the normalised pdf matrix in a POSIX shared memory segment,
+// so that fits running side by side on one node load the pdfs once and share
+// one copy of them.
+//
+// Lifetime is tracked with two lock files: every process using the segment holds
+// a shared flock on the users lock, and attaching, publishing and detaching all
+// happen under an exclusive flock on the create lock. Whoever can upgrade to an
+// exclusive users lock on the way out is the last user and unlinks the segment.
+// Locks die with their process, so a crashed fit never leaks a count.
+#ifndef __BBFIT__SharedPdfStore__
+#define __BBFIT__SharedPdfStore__
+#include <string>
+#include <vector>
+
+namespace bbfit{
+class SharedPdfStore{
+public:
+  // key_ should identify the pdfs completely, it is hashed into the segment name.
+  // If the segment isn't there the create lock is kept until Publish, so anyone
+  // else asking for the same key waits for it rather than loading the pdfs too
+  SharedPdfStore(const std::string& key_);
+  ~SharedPdfStore();
+
+  // true if the segment already existed and is now mapped
+  bool IsAttached() const;
+
+  // create the segment, only if not attached. probs_ is nBins_ x names_.size(), bin major
+  void Publish(const std::vector<std::string>& names_, size_t nBins_, 
+               const std::vector<double>& probs_);
+
+  const std::vector<std::string>& GetNames() const;
+  size_t GetNBins() const;
+  const double* GetProbs() const;
+
+  const std::string& GetSegmentName() const;
+
+private:
+  SharedPdfStore(const SharedPdfStore&);
+  SharedPdfStore& operator=(const SharedPdfStore&);
+
+  bool Attach();
+  void Map(int fd_, size_t size_);
+  int  OpenLock(const std::string& path_);
+
+  std::string fSegName;
+  int    fCreateFd;
+  int    fUsersFd;
+  void*  fMap;
+  size_t fMapSize;
+
+  std::vector<std::string> fNames;
+  size_t        fNBins;
+  const double* fProbs;
+};
+}
+#endif
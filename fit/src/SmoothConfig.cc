@@ -0,0 +1,45 @@
+#include <SmoothConfig.hh>
+
+namespace bbfit{
+
+const std::string&
+SmoothConfig::GetAxis() const{
+  return fAxis;
+}
+
+void
+SmoothConfig::SetAxis(const std::string& s_){
+  fAxis = s_;
+}
+
+const std::string&
+SmoothConfig::GetKernel() const{
+  return fKernel;
+}
+
+void
+SmoothConfig::SetKernel(const std::string& s_){
+  fKernel = s_;
+}
+
+double
+SmoothConfig::GetWidth() const{
+  return fWidth;
+}
+
+void
+SmoothConfig::SetWidth(double w_){
+  fWidth = w_;
+}
+
+int
+SmoothConfig::GetIterations() const{
+  return fIterations;
+}
+
+void
+SmoothConfig::SetIterations(int n_){
+  fIterations = n_;
+}
+
+}
@@ -0,0 +1,32 @@
+#ifndef __BBFIT__SmoothConfig__
+#define __BBFIT__SmoothConfig__
+#include <string>
+
+// one smoothing pass along one axis
+namespace bbfit{
+class SmoothConfig{
+public:
+  SmoothConfig() : fWidth(1), fIterations(1) {}
+
+  const std::string& GetAxis() const;
+  void SetAxis(const std::string&);
+
+  // root353qh (TH1::SmoothArray), gaussian or boxcar
+  const std::string& GetKernel() const;
+  void SetKernel(const std::string&);
+
+  // in bins: sigma for gaussian, half width for boxcar, unused by root353qh
+  double GetWidth() const;
+  void   SetWidth(double);
+
+  int  GetIterations() const;
+  void SetIterations(int);
+
+private:
+  std::string fAxis;
+  std::string fKernel;
+  double fWidth;
+  int    fIterations;
+};
+}
+#endif
@@ -0,0 +1,61 @@
+#include <SmoothConfigLoader.hh>
+#include <ConfigLoader.hh>
+#include <Exceptions.h>
+
+namespace bbfit{
+
+SmoothConfigLoader::SmoothConfigLoader(const std::string& filePath_){
+  fPath = filePath_;
+}
+
+SmoothConfigLoader::~SmoothConfigLoader(){
+  ConfigLoader::Close();
+}
+
+std::vector<SmoothConfig>
+SmoothConfigLoader::LoadActive() const{
+  ConfigLoader::Open(fPath);
+
+  std::vector<std::string> order;
+  ConfigLoader::Load("summary", "order", order);
+
+  std::vector<SmoothConfig> passes;
+  for(size_t i = 0; i < order.size(); i++){
+    SmoothConfig pass;
+
+    // the section is named after the axis, unless it says otherwise
+    std::string axis = order.at(i);
+    try{
+      ConfigLoader::Load(order.at(i), "axis", axis);
+    }
+    catch(const ConfigFieldMissing&){}
+    pass.SetAxis(axis);
+
+    std::string kernel;
+    ConfigLoader::Load(order.at(i), "kernel", kernel);
+    if(kernel != "root353qh" && kernel != "gaussian" && kernel != "boxcar")
+      throw ValueError("SmoothConfigLoader:: unknown kernel " + kernel + " for " + order.at(i) 
+                       + ", expected root353qh, gaussian or boxcar");
+    pass.SetKernel(kernel);
+
+    // both optional
+    double width;
+    try{
+      ConfigLoader::Load(order.at(i), "width", width);
+      pass.SetWidth(width);
+    }
+    catch(const ConfigFieldMissing&){}
+
+    int iterations;
+    try{
+      ConfigLoader::Load(order.at(i), "iterations", iterations);
+      pass.SetIterations(iterations);
+    }
+    catch(const ConfigFieldMissing&){}
+
+    passes.push_back(pass);
+  }
+  return passes;
+}
+
+}
@@ -0,0 +1,22 @@
+#ifndef __BBFIT__SmoothConfigLoader__
+#define __BBFIT__SmoothConfigLoader__
+#include <SmoothConfig.hh>
+#include <string>
+#include <vector>
+
+// [summary] order = energy,r then a section per pass: kernel, width, iterations
+// and optionally axis, if the section isn't named after it
+namespace bbfit{
+class SmoothConfigLoader{
+public:
+  SmoothConfigLoader(const std::string& filePath_);
+  ~SmoothConfigLoader();
+
+  // the passes in the order they run
+  std::vector<SmoothConfig> LoadActive() const;
+
+private:
+  std::string fPath;
+};
+}
+#endif
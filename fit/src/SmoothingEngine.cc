@@ -0,0 +1,192 @@
+#include <SmoothingEngine.hh>
+#include <BinnedED.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <TH1.h>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+
+namespace bbfit{
+
+// a block of lanes of one dist, all along the same axis
+struct SmoothTask{
+  double* fContents;
+  size_t  fFirstLane;
+  size_t  fLastLane;
+  size_t  fNBins;   // along the axis
+  size_t  fStride;
+};
+
+// lanes per task, enough to make the bookkeeping negligible
+static const size_t kLanesPerTask = 64;
+
+SmoothingEngine::SmoothingEngine(const std::vector<SmoothConfig>& passes_, unsigned nThreads_){
+  // caught here rather than in the middle of a pass on a worker thread
+  for(size_t p = 0; p < passes_.size(); p++){
+    const std::string& kernel = passes_.at(p).GetKernel();
+    if(kernel != "root353qh" && kernel != "gaussian" && kernel != "boxcar")
+      throw ValueError("SmoothingEngine:: unknown kernel " + kernel);
+  }
+  fPasses = passes_;
+  fNThreads = nThreads_ ? nThreads_ : std::thread::hardware_concurrency();
+  if(!fNThreads)
+    fNThreads = 1;
+}
+
+// convolve src_ with weights_ (centred, 2 * half + 1 of them), the kernel is 
+// renormalised where it runs off the ends so edges aren't pulled down
+static void
+Convolve(const std::vector<double>& src_, const std::vector<double>& weights_, 
+         std::vector<double>& dest_){
+  int n = src_.size();
+  int half = weights_.size() / 2;
+  dest_.resize(n);
+  for(int i = 0; i < n; i++){
+    double sum = 0;
+    double norm = 0;
+    int lo = std::max(0, i - half);
+    int hi = std::min(n - 1, i + half);
+    for(int k = lo; k <= hi; k++){
+      double w = weights_[k - i + half];
+      sum  += w * src_[k];
+      norm += w;
+    }
+    dest_[i] = norm ? sum/norm : 0;
+  }
+}
+
+void
+SmoothingEngine::SmoothLane(double* first_, size_t n_, size_t stride_, 
+                            const SmoothConfig& pass_, std::vector<double>& work_){
+  work_.resize(n_);
+  double before = 0;
+  for(size_t i = 0; i < n_; i++){
+    work_[i] = first_[i * stride_];
+    before += work_[i];
+  }
+  if(!before)
+    return;
+
+  const std::string& kernel = pass_.GetKernel();
+  if(kernel == "root353qh"){
+    // root needs at least 3 points
+    if(n_ < 3)
+      return;
+    TH1::SmoothArray(n_, &work_[0], pass_.GetIterations());
+  }
+  else{
+    std::vector<double> weights;
+    if(kernel == "gaussian"){
+      double sigma = pass_.GetWidth();
+      int half = std::ceil(3 * sigma);
+      for(int k = -half; k <= half; k++)
+        weights.push_back(sigma > 0 ? std::exp(-0.5 * k * k / (sigma * sigma)) : (k == 0));
+    }
+    else if(kernel == "boxcar"){
+      int half = pass_.GetWidth();
+      weights.assign(2 * half + 1, 1);
+    }
+    else
+      throw ValueError("SmoothingEngine:: unknown kernel " + kernel);
+
+    std::vector<double> smoothed;
+    for(int it = 0; it < pass_.GetIterations(); it++){
+      Convolve(work_, weights, smoothed);
+      work_.swap(smoothed);
+    }
+  }
+
+  // this lane keeps its own integral
+  double after = 0;
+  for(size_t i = 0; i < n_; i++)
+    after += work_[i];
+  double scale = after ? before/after : 0;
+  for(size_t i = 0; i < n_; i++)
+    first_[i * stride_] = work_[i] * scale;
+}
+
+// an exception can't leave a thread, the first is kept for Smooth to rethrow
+// and the remaining tasks are abandoned
+struct TaskError{
+  std::mutex         fMutex;
+  std::exception_ptr fError;
+};
+
+static void
+RunTasks(const std::vector<SmoothTask>& tasks_, const SmoothConfig& pass_, 
+         std::atomic<size_t>& next_, TaskError& error_){
+  std::vector<double> work;
+  try{
+    for(size_t t = next_++; t < tasks_.size(); t = next_++){
+      const SmoothTask& task = tasks_[t];
+      // lane l starts at the l-th bin whose index along the axis is 0
+      for(size_t l = task.fFirstLane; l < task.fLastLane; l++){
+        size_t start = (l / task.fStride) * task.fStride * task.fNBins + l % task.fStride;
+        SmoothingEngine::SmoothLane(task.fContents + start, task.fNBins, task.fStride, pass_, work);
+      }
+    }
+  }
+  catch(...){
+    std::lock_guard<std::mutex> lock(error_.fMutex);
+    if(!error_.fError)
+      error_.fError = std::current_exception();
+    next_ = tasks_.size();
+  }
+}
+
+void
+SmoothingEngine::Smooth(std::vector<BinnedED>& dists_) const{
+  std::vector<std::vector<double> > contents(dists_.size());
+  for(size_t k = 0; k < dists_.size(); k++)
+    contents[k] = dists_.at(k).GetBinContents();
+
+  for(size_t p = 0; p < fPasses.size(); p++){
+    const SmoothConfig& pass = fPasses.at(p);
+
+    std::vector<SmoothTask> tasks;
+    for(size_t k = 0; k < dists_.size(); k++){
+      const AxisCollection& axes = dists_.at(k).GetAxes();
+      std::vector<std::string> names = axes.GetAxisNames();
+      std::vector<std::string>::const_iterator it = std::find(names.begin(), names.end(), pass.GetAxis());
+      if(it == names.end())
+        throw NotFoundError("SmoothingEngine:: " + dists_.at(k).GetName() + " has no axis " + pass.GetAxis());
+      size_t dim = it - names.begin();
+
+      // the step between neighbours along this axis, whatever the bin ordering
+      std::vector<size_t> unit(axes.GetNDimensions(), 0);
+      unit[dim] = 1;
+      SmoothTask task;
+      task.fContents = contents[k].empty() ? NULL : &contents[k][0];
+      task.fNBins  = axes.GetAxis(dim).GetNBins();
+      task.fStride = axes.FlattenIndices(unit);
+
+      size_t nLanes = contents[k].size() / task.fNBins;
+      for(size_t first = 0; first < nLanes; first += kLanesPerTask){
+        task.fFirstLane = first;
+        task.fLastLane  = std::min(first + kLanesPerTask, nLanes);
+        tasks.push_back(task);
+      }
+    }
+
+    std::atomic<size_t> next(0);
+    TaskError error;
+    std::vector<std::thread> threads;
+    for(unsigned i = 0; i < std::min<size_t>(fNThreads, tasks.size()); i++)
+      threads.push_back(std::thread(RunTasks, std::cref(tasks), std::cref(pass), std::ref(next),
+                                    std::ref(error)));
+    for(size_t i = 0; i < threads.size(); i++)
+      threads[i].join();
+    if(error.fError)
+      std::rethrow_exception(error.fError);
+  }
+
+  for(size_t k = 0; k < dists_.size(); k++)
+    dists_[k].SetBinContents(contents[k]);
+}
+
+}
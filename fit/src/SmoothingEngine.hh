@@ -0,0 +1,31 @@
+// Smooths binned pdfs along any of their axes. Each pass runs the configured 
+// kernel along every 1D lane of its axis, straight on the bin contents, and 
+// rescales each lane back to the integral it had. Lanes of all the pdfs are 
+// shared out between threads, so the whole set is smoothed at once
+#ifndef __BBFIT__SmoothingEngine__
+#define __BBFIT__SmoothingEngine__
+#include <SmoothConfig.hh>
+#include <vector>
+#include <cstddef>
+
+class BinnedED;
+
+namespace bbfit{
+class SmoothingEngine{
+public:
+  // 0 threads means one per core, throws on an unknown kernel
+  SmoothingEngine(const std::vector<SmoothConfig>& passes_, unsigned nThreads_ = 0);
+
+  // all the passes, in order, on every dist
+  void Smooth(std::vector<BinnedED>& dists_) const;
+
+  // one lane of n_ bins stride_ apart, work_ is scratch space
+  static void SmoothLane(double* first_, size_t n_, size_t stride_, 
+                         const SmoothConfig& pass_, std::vector<double>& work_);
+
+private:
+  std::vector<SmoothConfig> fPasses;
+  unsigned fNThreads;
+};
+}
+#endif
@@ -0,0 +1,197 @@
+#include <StreamingDataSetGenerator.hh>
+#include <DataSetView.hh>
+#include <DataSet.h>
+#include <Event.h>
+#include <Rand.h>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <TFile.h>
+#include <TNtuple.h>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+
+namespace bbfit{
+
+void
+StreamingDataSetGenerator::AddDataSet(const std::string& name_, const std::string& path_,
+                                      double expectedCounts_, bool sequential_, bool bootstrap_){
+  DataSet* data = DataSetView::Open(path_, "pruned");
+  if(fObservables.empty())
+    fObservables = data->GetObservableNames();
+
+  Source src;
+  src.fName = name_;
+  src.fPath = path_;
+  src.fExpectedCounts = expectedCounts_;
+  src.fSequential = sequential_;
+  src.fBootstrap = bootstrap_;
+  src.fNEntries = data->GetNEntries();
+  src.fNUsed = 0;
+  delete data;
+  if(!bootstrap_)
+    src.fUsed.resize(src.fNEntries, false);
+  fSources.push_back(src);
+}
+
+size_t
+StreamingDataSetGenerator::GetNDataSets() const{
+  return fSources.size();
+}
+
+size_t
+StreamingDataSetGenerator::PoissonFluctuatedDataSet(const std::string& outPath_, 
+                                                    std::vector<int>* counts_){
+  std::string varList;
+  for(size_t i = 0; i < fObservables.size(); i++)
+    varList += (i ? ":" : "") + fObservables.at(i);
+
+  TFile outFile(outPath_.c_str(), "RECREATE");
+  TNtuple out("pruned", "", varList.c_str());
+
+  if(counts_)
+    counts_->clear();
+
+  size_t total = 0;
+  for(size_t i = 0; i < fSources.size(); i++){
+    Source& src = fSources[i];
+    size_t n = Rand::Poisson(src.fExpectedCounts);
+    size_t available = src.fBootstrap ? n : src.fNEntries - src.fNUsed;
+    if(n > available){
+      std::cout << "Warning:: only " << available << " " << src.fName << " events left, wanted " 
+                << n << std::endl;
+      n = available;
+    }
+
+    // one source open at a time
+    DataSet* data = DataSetView::Open(src.fPath, "pruned");
+    Draw(src, n, *data, out, data->GetObservableNames());
+    delete data;
+
+    if(counts_)
+      counts_->push_back(n);
+    total += n;
+  }
+
+  outFile.cd();
+  out.Write();
+  outFile.Close();
+  return total;
+}
+
+void
+StreamingDataSetGenerator::Draw(Source& src_, size_t n_, const DataSet& data_, TNtuple& out_,
+                                const std::vector<std::string>& obs_) const{
+  // where each output column lives in this source
+  std::vector<size_t> cols;
+  for(size_t i = 0; i < fObservables.size(); i++){
+    std::vector<std::string>::const_iterator it = std::find(obs_.begin(), obs_.end(), fObservables.at(i));
+    if(it == obs_.end())
+      throw NotFoundError(Formatter() << "StreamingDataSetGenerator:: " << src_.fName 
+                          << " has no observable " << fObservables.at(i));
+    cols.push_back(it - obs_.begin());
+  }
+
+  if(src_.fBootstrap)
+    DrawWithReplacement(src_, n_, data_, out_, cols);
+  else
+    DrawWithoutReplacement(src_, n_, data_, out_, cols);
+}
+
+void
+StreamingDataSetGenerator::DrawWithoutReplacement(Source& src_, size_t n_, const DataSet& data_, 
+                                                  TNtuple& out_, const std::vector<size_t>& cols_) const{
+  // walk the unused entries in order, skipping a random number before each pick
+  // (Vitter's method A) so every subset of n of them is equally likely and we only
+  // need one random number per event chosen. Sequential sets never skip
+  std::vector<Float_t> row(cols_.size());
+  size_t remaining = src_.fNEntries - src_.fNUsed;
+  double top = remaining - n_;
+  double nReal = remaining;
+  size_t entry = 0;
+  for(size_t n = n_; n > 0; n--){
+    size_t skip = 0;
+    if(!src_.fSequential){
+      double v = Rand::Uniform();
+      if(n > 1){
+        double quot = top/nReal;
+        while(quot > v){
+          skip++;
+          top--;
+          nReal--;
+          quot *= top/nReal;
+        }
+      }
+      else
+        skip = std::min(size_t(nReal * v), size_t(nReal) - 1);
+    }
+    nReal--;
+
+    // move over the skipped unused entries to the next one
+    while(src_.fUsed[entry])
+      entry++;
+    for(; skip > 0; skip--){
+      entry++;
+      while(src_.fUsed[entry])
+        entry++;
+    }
+
+    Event ev = data_.GetEntry(entry);
+    const std::vector<double>& data = ev.GetData();
+    for(size_t i = 0; i < cols_.size(); i++)
+      row[i] = data.at(cols_.at(i));
+    out_.Fill(&row.at(0));
+
+    src_.fUsed[entry] = true;
+    src_.fNUsed++;
+  }
+}
+
+void
+StreamingDataSetGenerator::DrawWithReplacement(Source& src_, size_t n_, const DataSet& data_, 
+                                               TNtuple& out_, const std::vector<size_t>& cols_) const{
+  // uniform order statistics generated from the top down, so the draws come out
+  // sorted without having to hold them
+  std::vector<Float_t> row(cols_.size());
+  double u = 1;
+  for(size_t k = n_; k > 0; k--){
+    u *= pow(1 - Rand::Uniform(), 1./k);
+    size_t entry = std::min(size_t(u * src_.fNEntries), src_.fNEntries - 1);
+
+    Event ev = data_.GetEntry(entry);
+    const std::vector<double>& data = ev.GetData();
+    for(size_t i = 0; i < cols_.size(); i++)
+      row[i] = data.at(cols_.at(i));
+    out_.Fill(&row.at(0));
+  }
+}
+
+size_t
+StreamingDataSetGenerator::SaveRemainder(size_t i_, const std::string& indexPath_) const{
+  const Source& src = fSources.at(i_);
+  if(src.fBootstrap)
+    throw ValueError("StreamingDataSetGenerator:: " + src.fName + " was drawn with replacement, there's no remainder");
+
+  // if the source is itself a view, point the index at the ntuple underneath it
+  DataSet* data = DataSetView::Open(src.fPath, "pruned");
+  const DataSetView* view = dynamic_cast<const DataSetView*>(data);
+
+  EntryRanges ranges;
+  size_t nLeft = 0;
+  for(size_t i = 0; i < src.fNEntries; i++){
+    if(src.fUsed[i])
+      continue;
+    size_t entry = view ? view->GetSourceEntry(i) : i;
+    if(!ranges.empty() && ranges.back().second == entry)
+      ranges.back().second++;
+    else
+      ranges.push_back(std::make_pair(entry, entry + 1));
+    nLeft++;
+  }
+
+  DataSetView::Save(indexPath_, view ? view->GetSourcePath() : src.fPath, ranges);
+  delete data;
+  return nLeft;
+}
+
+}
@@ -0,0 +1,52 @@
+// Builds fake data sets by streaming the chosen events of each type straight to
+// the output ntuple. Only one source is open at a time and nothing is held in
+// memory except one bit per source entry to remember what has been used
+#ifndef __BBFIT__StreamingDataSetGenerator__
+#define __BBFIT__StreamingDataSetGenerator__
+#include <string>
+#include <vector>
+
+class DataSet;
+class TNtuple;
+
+namespace bbfit{
+class StreamingDataSetGenerator{
+public:
+  // sequential: take the next unused events in order, otherwise a random choice of the unused ones
+  // bootstrap: draw with replacement, these events are never used up
+  void AddDataSet(const std::string& name_, const std::string& path_, 
+                  double expectedCounts_, bool sequential_, bool bootstrap_);
+  size_t GetNDataSets() const;
+
+  // poisson fluctuate the expected counts and write the events to outPath_.
+  // Fills the number of each type drawn, returns the total
+  size_t PoissonFluctuatedDataSet(const std::string& outPath_, std::vector<int>* counts_);
+
+  // the events of type i_ never drawn, saved as an index over the original ntuple.
+  // Returns how many there are
+  size_t SaveRemainder(size_t i_, const std::string& indexPath_) const;
+
+private:
+  struct Source{
+    std::string fName;
+    std::string fPath;
+    double fExpectedCounts;
+    bool   fSequential;
+    bool   fBootstrap;
+    size_t fNEntries;
+    size_t fNUsed;
+    std::vector<bool> fUsed;
+  };
+  
+  void Draw(Source&, size_t n_, const DataSet& data_, TNtuple& out_, 
+            const std::vector<std::string>& obs_) const;
+  void DrawWithoutReplacement(Source&, size_t n_, const DataSet& data_, TNtuple& out_, 
+                              const std::vector<size_t>& cols_) const;
+  void DrawWithReplacement(Source&, size_t n_, const DataSet& data_, TNtuple& out_, 
+                           const std::vector<size_t>& cols_) const;
+
+  std::vector<Source> fSources;
+  std::vector<std::string> fObservables; // of the output, taken from the first source
+};
+}
+#endif
@@ -0,0 +1,49 @@
+#include <TemplateConfig.hh>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+
+namespace bbfit{
+
+const std::vector<std::string>&
+TemplateConfig::GetDirs() const{
+  return fDirs;
+}
+
+const std::vector<double>&
+TemplateConfig::GetValues() const{
+  return fValues;
+}
+
+void
+TemplateConfig::SetGrid(const std::vector<std::string>& dirs_, const std::vector<double>& values_){
+  if(dirs_.size() != values_.size() || dirs_.size() < 2)
+    throw ValueError(Formatter() << "TemplateConfig:: need a value for each of at least 2 pdf dirs, got "
+                     << dirs_.size() << " dirs and " << values_.size() << " values");
+  for(size_t i = 1; i < values_.size(); i++)
+    if(values_.at(i) <= values_.at(i - 1))
+      throw ValueError("TemplateConfig:: template values must be ascending");
+  fDirs = dirs_;
+  fValues = values_;
+}
+
+const std::vector<std::string>&
+TemplateConfig::GetPdfs() const{
+  return fPdfs;
+}
+
+void
+TemplateConfig::SetPdfs(const std::vector<std::string>& pdfs_){
+  fPdfs = pdfs_;
+}
+
+bool
+TemplateConfig::GetExponential() const{
+  return fExponential;
+}
+
+void
+TemplateConfig::SetExponential(bool b_){
+  fExponential = b_;
+}
+
+}
@@ -0,0 +1,33 @@
+#ifndef __BBFIT__TemplateConfig__
+#define __BBFIT__TemplateConfig__
+#include <string>
+#include <vector>
+
+// a fit parameter that interpolates pdfs between sets built at a few values 
+// of some condition, each set in its own pdf directory
+namespace bbfit{
+class TemplateConfig{
+public:
+  TemplateConfig() : fExponential(false) {}
+
+  // one per grid point, values ascending
+  const std::vector<std::string>& GetDirs() const;
+  const std::vector<double>& GetValues() const;
+  void SetGrid(const std::vector<std::string>& dirs_, const std::vector<double>& values_);
+
+  // the pdfs that are interpolated, empty for all the fitted ones
+  const std::vector<std::string>& GetPdfs() const;
+  void SetPdfs(const std::vector<std::string>&);
+
+  // bin contents interpolated in log rather than linearly
+  bool GetExponential() const;
+  void SetExponential(bool);
+
+private:
+  std::vector<std::string> fDirs;
+  std::vector<double> fValues;
+  std::vector<std::string> fPdfs;
+  bool fExponential;
+};
+}
+#endif
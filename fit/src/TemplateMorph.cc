@@ -0,0 +1,135 @@
+#include <TemplateMorph.hh>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace bbfit{
+
+// interpolated matrices kept, enough for a gradient's worth of shifted parameters
+static const size_t kMaxRecent = 4;
+
+// log of an empty bin, it stays empty in between unless both ends are filled
+static const double kLogFloor = -700;
+
+TemplateMorph::TemplateMorph(size_t nBins_, size_t nPdfs_) : fNBins(nBins_), fNPdfs(nPdfs_), 
+                                                               fMorphed(nPdfs_, false){}
+
+const std::vector<size_t>&
+TemplateMorph::GetParams() const{
+  return fParams;
+}
+
+void
+TemplateMorph::AddParameter(size_t param_, const std::vector<size_t>& columns_,
+                            const std::vector<double>& values_,
+                            const std::vector<std::vector<double> >& variants_,
+                            bool exponential_){
+  if(values_.size() < 2 || variants_.size() != values_.size())
+    throw ValueError(Formatter() << "TemplateMorph:: need templates at 2 or more values, got " 
+                     << variants_.size() << " for " << values_.size() << " values");
+
+  size_t nCols = columns_.size();
+  for(size_t c = 0; c < nCols; c++){
+    if(columns_.at(c) >= fNPdfs || fMorphed.at(columns_.at(c)))
+      throw ValueError(Formatter() << "TemplateMorph:: pdf column " << columns_.at(c) 
+                       << " doesn't exist or is already morphed");
+    fMorphed[columns_.at(c)] = true;
+  }
+
+  Parameter par;
+  par.fColumns = columns_;
+  par.fValues  = values_;
+  par.fExponential = exponential_;
+  for(size_t k = 0; k + 1 < values_.size(); k++){
+    const std::vector<double>& lo = variants_.at(k);
+    const std::vector<double>& hi = variants_.at(k + 1);
+    if(lo.size() != fNBins * nCols || hi.size() != fNBins * nCols)
+      throw DimensionError(Formatter() << "TemplateMorph:: templates have " << lo.size() 
+                           << " entries, expected " << fNBins << " x " << nCols);
+
+    std::vector<double> base(fNBins * nCols);
+    std::vector<double> slope(fNBins * nCols);
+    for(size_t idx = 0; idx < lo.size(); idx++){
+      if(!exponential_){
+        base[idx]  = lo[idx];
+        slope[idx] = hi[idx] - lo[idx];
+      }
+      else{
+        double logLo = lo[idx] > 0 ? log(lo[idx]) : kLogFloor;
+        double logHi = hi[idx] > 0 ? log(hi[idx]) : kLogFloor;
+        base[idx]  = logLo;
+        slope[idx] = logHi - logLo;
+      }
+    }
+    par.fBase.push_back(base);
+    par.fSlope.push_back(slope);
+  }
+  fParams.push_back(param_);
+  fParameters.push_back(par);
+}
+
+std::shared_ptr<const TemplateMorph::Interpolated>
+TemplateMorph::Apply(const double* nominal_, const double* params_) const{
+  std::vector<double> key(fParams.size());
+  for(size_t p = 0; p < fParams.size(); p++)
+    key[p] = params_[fParams[p]];
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    for(size_t i = 0; i < fRecent.size(); i++)
+      if(fRecent[i]->fKey == key)
+        return fRecent[i];
+  }
+
+  std::shared_ptr<Interpolated> interp(new Interpolated);
+  interp->fKey = key;
+  interp->fProbs.assign(nominal_, nominal_ + fNBins * fNPdfs);
+  std::vector<double>& probs = interp->fProbs;
+
+  for(size_t p = 0; p < fParameters.size(); p++){
+    const Parameter& par = fParameters[p];
+    const std::vector<double>& values = par.fValues;
+
+    // clamp to the grid and find the segment
+    double x = std::min(std::max(key[p], values.front()), values.back());
+    size_t k = std::upper_bound(values.begin(), values.end(), x) - values.begin();
+    k = std::min(std::max(k, (size_t)1), values.size() - 1) - 1;
+    double t = (x - values[k])/(values[k + 1] - values[k]);
+
+    const double* base  = &par.fBase[k][0];
+    const double* slope = &par.fSlope[k][0];
+    size_t nCols = par.fColumns.size();
+    const size_t* cols = &par.fColumns[0];
+    std::vector<double> sums(nCols, 0);
+    for(size_t i = 0; i < fNBins; i++){
+      double* row = &probs[i * fNPdfs];
+      const double* a = base + i * nCols;
+      const double* b = slope + i * nCols;
+      for(size_t c = 0; c < nCols; c++){
+        double v = par.fExponential ? exp(a[c] + t * b[c]) : a[c] + t * b[c];
+        row[cols[c]] = v;
+        sums[c] += v;
+      }
+    }
+
+    // linear stays normalised, exponential doesn't
+    if(par.fExponential)
+      for(size_t i = 0; i < fNBins; i++)
+        for(size_t c = 0; c < nCols; c++)
+          if(sums[c])
+            probs[i * fNPdfs + cols[c]] /= sums[c];
+  }
+
+  interp->fTotals.assign(fNPdfs, 0);
+  for(size_t i = 0; i < fNBins; i++)
+    for(size_t j = 0; j < fNPdfs; j++)
+      interp->fTotals[j] += probs[i * fNPdfs + j];
+
+  std::lock_guard<std::mutex> lock(fMutex);
+  fRecent.push_front(interp);
+  if(fRecent.size() > kMaxRecent)
+    fRecent.pop_back();
+  return interp;
+}
+
+}
@@ -0,0 +1,61 @@
+// Vertical interpolation of pdfs between templates built at a grid of values
+// of some parameter. For each grid segment the per-bin coefficients are 
+// computed once: p(t) = a + t b (linear) or a exp(t b) (exponential), t the 
+// fraction of the way along the segment, so an evaluation is a single pass 
+// over the morphed columns. Several parameters may each morph their own pdfs
+#ifndef __BBFIT__TemplateMorph__
+#define __BBFIT__TemplateMorph__
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <cstddef>
+
+namespace bbfit{
+class TemplateMorph{
+public:
+  TemplateMorph(size_t nBins_, size_t nPdfs_);
+
+  // at values_[k] the pdf matrix columns columns_ are variants_[k], bin major
+  // nBins x columns_.size() and normalised like the nominal. Outside the grid 
+  // the end templates are used
+  void AddParameter(size_t param_, const std::vector<size_t>& columns_,
+                    const std::vector<double>& values_,
+                    const std::vector<std::vector<double> >& variants_,
+                    bool exponential_);
+
+  struct Interpolated{
+    std::vector<double> fKey;    // the parameter values
+    std::vector<double> fProbs;  // bin major, like the nominal
+    std::vector<double> fTotals;
+  };
+
+  // nominal_ supplies the columns nobody morphs. Safe to call from several threads
+  std::shared_ptr<const Interpolated> Apply(const double* nominal_, const double* params_) const;
+
+  const std::vector<size_t>& GetParams() const;
+
+private:
+  TemplateMorph(const TemplateMorph&);
+  TemplateMorph& operator=(const TemplateMorph&);
+
+  struct Parameter{
+    std::vector<size_t> fColumns;
+    std::vector<double> fValues;
+    bool fExponential;
+    // per segment, bin major nBins x nColumns
+    std::vector<std::vector<double> > fBase;
+    std::vector<std::vector<double> > fSlope;
+  };
+
+  size_t fNBins;
+  size_t fNPdfs;
+  std::vector<size_t>    fParams;
+  std::vector<Parameter> fParameters;
+  std::vector<bool>      fMorphed; // per column
+
+  mutable std::mutex fMutex;
+  mutable std::deque<std::shared_ptr<const Interpolated> > fRecent;
+};
+}
+#endif
@@ -0,0 +1,77 @@
+#include <ThreadPool.hh>
+
+namespace bbfit{
+
+ThreadPool::ThreadPool(size_t nThreads_) : fTask(NULL), fNTasks(0), fNext(0), fNFinished(0), 
+                                           fBatch(0), fStop(false){
+  if(!nThreads_)
+    nThreads_ = std::thread::hardware_concurrency();
+  for(size_t i = 1; i < nThreads_; i++)
+    fThreads.push_back(std::thread(&ThreadPool::Work, this));
+}
+
+ThreadPool::~ThreadPool(){
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = true;
+  }
+  fWake.notify_all();
+  for(size_t i = 0; i < fThreads.size(); i++)
+    fThreads[i].join();
+}
+
+size_t
+ThreadPool::GetNThreads() const{
+  return fThreads.size() + 1;
+}
+
+void
+ThreadPool::Drain(std::unique_lock<std::mutex>& lock_){
+  while(fNext < fNTasks){
+    size_t i = fNext++;
+    lock_.unlock();
+    (*fTask)(i);
+    lock_.lock();
+    if(++fNFinished == fNTasks)
+      fDone.notify_all();
+  }
+}
+
+void
+ThreadPool::Work(){
+  unsigned long seen = 0;
+  std::unique_lock<std::mutex> lock(fMutex);
+  while(true){
+    while(!fStop && fBatch == seen)
+      fWake.wait(lock);
+    if(fStop)
+      return;
+    seen = fBatch;
+    Drain(lock);
+  }
+}
+
+void
+ThreadPool::Run(size_t nTasks_, const std::function<void(size_t)>& task_){
+  std::unique_lock<std::mutex> run(fRunMutex, std::try_to_lock);
+  if(!run.owns_lock() || fThreads.empty() || nTasks_ < 2){
+    for(size_t i = 0; i < nTasks_; i++)
+      task_(i);
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(fMutex);
+  fTask = &task_;
+  fNTasks = nTasks_;
+  fNext = 0;
+  fNFinished = 0;
+  fBatch++;
+  fWake.notify_all();
+
+  Drain(lock);
+  while(fNFinished < fNTasks)
+    fDone.wait(lock);
+  fTask = NULL;
+}
+
+}
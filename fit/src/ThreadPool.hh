@@ -0,0 +1,49 @@
+#ifndef __BBFIT__ThreadPool__
+#define __BBFIT__ThreadPool__
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// Threads started once and woken for each batch of tasks, for work that is 
+// split up many times a second (every likelihood call of a sampler) where 
+// starting threads each time would cost more than the work. The calling 
+// thread takes tasks too. One batch at a time: a Run called while another is 
+// going does its tasks itself, so a pool can be shared freely. Tasks must not 
+// throw
+
+namespace bbfit{
+class ThreadPool{
+public:
+  // nThreads_ including the caller, 0 for one per core
+  ThreadPool(size_t nThreads_ = 0);
+  ~ThreadPool();
+
+  size_t GetNThreads() const;
+
+  // task_(i) for i in [0, nTasks_), returns when they have all finished
+  void Run(size_t nTasks_, const std::function<void(size_t)>& task_);
+
+private:
+  ThreadPool(const ThreadPool&);
+  ThreadPool& operator=(const ThreadPool&);
+
+  void Work();
+  // takes tasks from the current batch until there are none left, lock_ held on entry and exit
+  void Drain(std::unique_lock<std::mutex>& lock_);
+
+  std::vector<std::thread> fThreads;
+  std::mutex fRunMutex;  // held for a whole batch
+  std::mutex fMutex;     // everything below
+  std::condition_variable fWake;
+  std::condition_variable fDone;
+  const std::function<void(size_t)>* fTask;
+  size_t fNTasks;
+  size_t fNext;
+  size_t fNFinished;
+  unsigned long fBatch;
+  bool fStop;
+};
+}
+#endif
@@ -0,0 +1,149 @@
+#include <WarmStart.hh>
+#include <Exceptions.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <sys/stat.h>
+
+namespace bbfit{
+
+WarmStart::WarmStart(const std::string& path_, const ParameterLayout& layout_) : fLayout(layout_),
+                                                                               fNAdjusted(0),
+                                                                               fHasCovariance(false){
+  const std::vector<double>& minima = fLayout.GetMinima();
+  const std::vector<double>& maxima = fLayout.GetMaxima();
+  const std::vector<double>& sigmas = fLayout.GetSigmas();
+  for(size_t i = 0; i < fLayout.GetNParams(); i++){
+    fInitialPoint.push_back(0.5 * (minima.at(i) + maxima.at(i)));
+    fMasses.push_back(1/sigmas.at(i)/sigmas.at(i));
+  }
+
+  struct stat st = {0};
+  if(stat(path_.c_str(), &st) == -1)
+    throw IOError("WarmStart:: nothing to start from at " + path_);
+  std::string dir = path_;
+  std::string resultPath = path_ + "/fit_result.txt";
+  if(!S_ISDIR(st.st_mode)){
+    size_t slash = path_.find_last_of('/');
+    dir = slash == std::string::npos ? "." : path_.substr(0, slash);
+    resultPath = path_;
+  }
+
+  LoadResult(resultPath);
+  std::string covPath = dir + "/covariance.txt";
+  if(stat(covPath.c_str(), &st) != -1)
+    LoadCovariance(covPath);
+  else
+    std::cout << "WarmStart:: no covariance at " << covPath << ", keeping the default masses" << std::endl;
+}
+
+void
+WarmStart::LoadResult(const std::string& path_){
+  std::ifstream ifs(path_.c_str());
+  if(!ifs)
+    throw IOError("WarmStart:: couldn't open " + path_);
+
+  // a header line, then name\tvalue
+  std::vector<bool> found(fLayout.GetNParams(), false);
+  std::string line;
+  while(std::getline(ifs, line)){
+    if(line.empty() || line.find("Best fit") == 0)
+      continue;
+    std::istringstream ss(line);
+    std::string name;
+    double value;
+    if(!(ss >> name >> value) || !fLayout.HasParameter(name))
+      continue;
+    size_t index = fLayout.GetIndex(name);
+    fInitialPoint[index] = std::min(std::max(value, fLayout.GetMinima().at(index)), 
+                                    fLayout.GetMaxima().at(index));
+    found[index] = true;
+    if(fInitialPoint[index] != value){
+      fNAdjusted++;
+      std::cout << "WarmStart:: " << name << " = " << value << " is outside the box, starting it at " 
+                << fInitialPoint[index] << std::endl;
+    }
+  }
+
+  for(size_t i = 0; i < found.size(); i++)
+    if(!found[i]){
+      fNAdjusted++;
+      std::cout << "WarmStart:: " << fLayout.GetName(i) << " isn't in " << path_ 
+                << ", starting it mid range" << std::endl;
+    }
+}
+
+void
+WarmStart::LoadCovariance(const std::string& path_){
+  std::ifstream ifs(path_.c_str());
+  if(!ifs)
+    throw IOError("WarmStart:: couldn't open " + path_);
+
+  // # then the column names, then a row per name, see LaplaceApproximation::SaveCovariance
+  std::string line;
+  std::getline(ifs, line);
+  std::istringstream header(line);
+  std::string name;
+  header >> name;
+  std::vector<std::string> columns;
+  while(header >> name)
+    columns.push_back(name);
+
+  while(std::getline(ifs, line)){
+    std::istringstream ss(line);
+    if(!(ss >> name))
+      continue;
+    std::vector<double> row;
+    double value;
+    while(ss >> value)
+      row.push_back(value);
+    if(row.size() != columns.size())
+      throw IOError(Formatter() << "WarmStart:: row " << name << " of " << path_ << " has " 
+                    << row.size() << " entries for " << columns.size() << " columns");
+
+    std::vector<std::string>::iterator it = std::find(columns.begin(), columns.end(), name);
+    if(!fLayout.HasParameter(name) || it == columns.end())
+      continue;
+    double variance = row.at(it - columns.begin());
+    if(variance > 0 && std::isfinite(variance)){
+      fMasses[fLayout.GetIndex(name)] = 1/variance;
+      fHasCovariance = true;
+    }
+  }
+  // an empty or degenerate file says nothing about the scales, keep the defaults
+  if(!fHasCovariance)
+    std::cout << "WarmStart:: no usable variances in " << path_ << ", keeping the default masses" << std::endl;
+}
+
+const std::vector<double>&
+WarmStart::GetInitialPoint() const{
+  return fInitialPoint;
+}
+
+int
+WarmStart::GetNAdjusted() const{
+  return fNAdjusted;
+}
+
+bool
+WarmStart::HasCovariance() const{
+  return fHasCovariance;
+}
+
+const std::vector<double>&
+WarmStart::GetMasses() const{
+  return fMasses;
+}
+
+double
+WarmStart::GetEpsilon(double default_, int nSteps_) const{
+  if(!fHasCovariance || nSteps_ < 1)
+    return default_;
+  // and no bigger than the usual d^-1/4 scaling for a high acceptance rate
+  double quarter = 0.5 * M_PI / nSteps_;
+  return std::min(quarter, pow(double(fLayout.GetNParams()), -0.25));
+}
+
+}
@@ -0,0 +1,48 @@
+#ifndef __BBFIT__WarmStart__
+#define __BBFIT__WarmStart__
+#include <ParameterLayout.hh>
+#include <vector>
+#include <string>
+
+// Starting point and HMC tuning from an earlier fit of a similar data set, 
+// e.g. the Asimov fit before an ensemble of toys. Parameters are matched by
+// name, anything the earlier fit didn't have starts in the middle of its box
+// with the layout's sigma
+
+namespace bbfit{
+class WarmStart{
+public:
+  // path_ is a fit_result.txt or the output directory of the fit that wrote 
+  // one. The covariance.txt next to it is used if it's there
+  WarmStart(const std::string& path_, const ParameterLayout& layout_);
+
+  // the earlier best fit, inside the box
+  const std::vector<double>& GetInitialPoint() const;
+
+  // parameters the earlier fit didn't have, or had outside this box, so the 
+  // initial point isn't at its mode
+  int GetNAdjusted() const;
+
+  // found a covariance.txt with at least one positive, finite variance
+  bool HasCovariance() const;
+
+  // 1/variance from the covariance, diagonal like IndexedHMC's masses
+  const std::vector<double>& GetMasses() const;
+
+  // with those masses the dynamics are close to unit harmonic motion, a 
+  // quarter period over the nSteps_ leapfrog steps moves to a nearly 
+  // independent point. default_ without a covariance
+  double GetEpsilon(double default_, int nSteps_) const;
+
+private:
+  void LoadResult(const std::string& path_);
+  void LoadCovariance(const std::string& path_);
+
+  ParameterLayout     fLayout;
+  std::vector<double> fInitialPoint;
+  std::vector<double> fMasses;
+  int                 fNAdjusted;
+  bool                fHasCovariance;
+};
+}
+#endif
@@ -0,0 +1,83 @@
+#include <WeightedCutLog.hh>
+#include <Exceptions.h>
+#include <Formatter.hpp>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+
+namespace bbfit{
+
+WeightedCutLog::WeightedCutLog(const std::vector<std::string>& cutNames_) : fCutNames(cutNames_),
+                                                                            fCutCounts(cutNames_.size(), 0),
+                                                                            fCutWeights(cutNames_.size(), 0),
+                                                                            fPassCount(0), fPassWeight(0),
+                                                                            fCutWeightsKnown(true){}
+
+void
+WeightedCutLog::LogCut(size_t cut_, double weight_){
+  if(cut_ >= fCutCounts.size())
+    throw NotFoundError(Formatter() << "WeightedCutLog:: no cut " << cut_);
+  fCutCounts[cut_]++;
+  fCutWeights[cut_] += weight_;
+}
+
+void
+WeightedCutLog::LogPass(double weight_){
+  fPassCount++;
+  fPassWeight += weight_;
+}
+
+void
+WeightedCutLog::SetCutCounts(const std::vector<int>& counts_){
+  if(counts_.size() != fCutCounts.size())
+    throw DimensionError(Formatter() << "WeightedCutLog:: " << counts_.size() 
+                         << " counts for " << fCutCounts.size() << " cuts");
+  fCutCounts = counts_;
+  fCutWeightsKnown = false;
+}
+
+const std::vector<int>&
+WeightedCutLog::GetCutCounts() const{
+  return fCutCounts;
+}
+
+const std::vector<double>&
+WeightedCutLog::GetCutWeights() const{
+  return fCutWeights;
+}
+
+int
+WeightedCutLog::GetPassCount() const{
+  return fPassCount;
+}
+
+double
+WeightedCutLog::GetPassWeight() const{
+  return fPassWeight;
+}
+
+std::string
+WeightedCutLog::AsString() const{
+  std::ostringstream ss;
+  ss << std::left << std::setw(25) << "cut" << std::setw(15) << "events" << "weight" << "\n";
+  for(size_t i = 0; i < fCutNames.size(); i++){
+    ss << std::setw(25) << fCutNames.at(i) << std::setw(15) << fCutCounts.at(i);
+    if(fCutWeightsKnown)
+      ss << fCutWeights.at(i);
+    else
+      ss << "-";
+    ss << "\n";
+  }
+  ss << std::setw(25) << "passing" << std::setw(15) << fPassCount << fPassWeight << "\n";
+  return ss.str();
+}
+
+void
+WeightedCutLog::SaveAs(const std::string& title_, const std::string& path_) const{
+  std::ofstream ofs(path_.c_str());
+  if(!ofs)
+    throw IOError("WeightedCutLog:: couldn't open " + path_);
+  ofs << title_ << "\n\n" << AsString();
+}
+
+}
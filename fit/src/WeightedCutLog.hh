@@ -0,0 +1,37 @@
+#ifndef __BBFIT__WeightedCutLog__
+#define __BBFIT__WeightedCutLog__
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// CutLog for weighted events: the number and the summed weight of events
+// falling at each cut and passing them all
+namespace bbfit{
+class WeightedCutLog{
+public:
+  WeightedCutLog(const std::vector<std::string>& cutNames_);
+
+  void LogCut(size_t cut_, double weight_);
+  void LogPass(double weight_);
+
+  // a CutIndex only remembers the counts, its weights at each cut are lost
+  void SetCutCounts(const std::vector<int>& counts_);
+
+  const std::vector<int>&    GetCutCounts() const;
+  const std::vector<double>& GetCutWeights() const;
+  int    GetPassCount() const;
+  double GetPassWeight() const;
+
+  std::string AsString() const;
+  void SaveAs(const std::string& title_, const std::string& path_) const;
+
+private:
+  std::vector<std::string> fCutNames;
+  std::vector<int>    fCutCounts;
+  std::vector<double> fCutWeights;
+  int    fPassCount;
+  double fPassWeight;
+  bool   fCutWeightsKnown;
+};
+}
+#endif
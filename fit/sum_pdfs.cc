@@ -14,8 +14,11 @@
 #include <TH2D.h>
 #include <AxisCollection.h>
 #include <BinAxis.h>
+#include <PdfBundle.hh>
+#include <FactorisedPdf.hh>
 
 #include <HistTools.h>
+#include <OutputContainer.hh>
 #include <iostream>
 using namespace bbfit;
 
@@ -49,11 +52,12 @@ int main(int argc, char *argv[]){
 
   // and another one for the projections - there will be loads
   std::string projDir = sumDir + "/projections";
-  if (stat(projDir.c_str(), &st) == -1) {
+  if (!pConfig.GetOutputContainer() && stat(projDir.c_str(), &st) == -1) {
     mkdir(projDir.c_str(), 0700);
   }
   
-  std::cout << "\nSaving projections logs to " << projDir << std::endl;
+  std::cout << "\nSaving projections logs to " 
+            << (pConfig.GetOutputContainer() ? OutputContainer::PathFor(projDir) : projDir) << std::endl;
 
   // load up all the event types we want pdfs for
 	std::vector<BinnedED> dists;
@@ -63,14 +67,27 @@ int main(int argc, char *argv[]){
   EventConfigLoader loader(evConfigFile);
   EvMap toGet = loader.LoadActive();
 
+  // with a bundle the inputs come from one file, opened once
+  PdfBundle* bundle = NULL;
+  if(pConfig.GetBundle())
+    bundle = new PdfBundle(PdfBundle::BundlePath(pdfDir));
+  std::vector<BinnedED> summed;
   
   for(EvMap::iterator it = toGet.begin(); it != toGet.end(); ++it){    
     std::cout << "Retrieving distribution for " << it->first << std::endl;
     std::string distPath = pdfDir + "/" + it->first + ".h5";
 		
-    BinnedED dist = BinnedED(it->first, IO::LoadHistogram(distPath));
+    BinnedED dist = bundle ? bundle->Load(it->first) : BinnedED(it->first, IO::LoadHistogram(distPath));
     dists.push_back(dist);
 
+    // the composite below is f(E, r) g(PSD | r), also keep it as just those 
+    // two factors for factorised fits
+    std::vector<std::string> marginalAxes;
+    marginalAxes.push_back(dist.GetAxes().GetAxis(0).GetName());
+    marginalAxes.push_back(dist.GetAxes().GetAxis(1).GetName());
+    std::vector<std::string> condAxes(1, dist.GetAxes().GetAxis(1).GetName());
+    FactorisedPdf::Factorise(dist, marginalAxes, condAxes).Save(sumDir);
+
 		
     //full range
     double energyLowPSD = 1.8;
@@ -237,25 +254,20 @@ int main(int argc, char *argv[]){
     
     // save as h5
     IO::SaveHistogram(dist.GetHistogram(), sumDir + "/" + it->first + ".h5");
+    summed.push_back(dist);
 
     // save as a root histogram if possible
     if(dist.GetNDims() <= 2)
       IO::SaveHistogram(dist.GetHistogram(), sumDir + "/" + it->first + ".root");
+  }
 
-    // HigherD save the projections
-    if(dist.GetNDims() > 1){
-      std::vector<BinnedED> projs = HistTools::GetVisualisableProjections(dist);
-      
-      // save them as apropriate
-      for(size_t i = 0; i < projs.size(); i++){
-	const BinnedED& proj = projs.at(i);
-	
-	if(projs.at(i).GetNDims() == 1)
-	  DistTools::ToTH1D(proj).SaveAs((projDir + "/" + proj.GetName() + ".root").c_str());
-	else
-	  DistTools::ToTH2D(proj).SaveAs((projDir + "/" + proj.GetName() + ".root").c_str());
-      }
-    }
+  // HigherD save the projections, computed for all the dists at once
+  OutputContainer::Save(OutputContainer::Projections(summed), projDir, pConfig.GetOutputContainer());
+
+  if(bundle){
+    std::cout << "\nWriting pdf bundle " << PdfBundle::BundlePath(sumDir) << std::endl;
+    PdfBundle::Save(PdfBundle::BundlePath(sumDir), summed);
+    delete bundle;
   }
   
   return 0;